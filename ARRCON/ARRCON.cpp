@@ -4,10 +4,20 @@
 
 // ARRCON
 #include "net/rcon.hpp"
+#include "net/fanout.hpp"
+#include "net/bench.hpp"
+#include "net/daemon.hpp"
+#include "net/background_resolver.hpp"
 #include "config.hpp"
+#include "hosts_index.hpp"
 #include "helpers/print_input_prompt.h"
 #include "helpers/bukkit-colors.h"
 #include "helpers/FileLocator.hpp"
+#include "helpers/TrimmedWriter.hpp"
+#include "helpers/NdjsonWriter.hpp"
+#include "helpers/LineReader.hpp"
+#include "helpers/ScriptFile.hpp"
+#include "helpers/StartupTrace.hpp"
 
 // 307lib
 #include <opt3.hpp>					//< for commandline argument parser & manager
@@ -17,7 +27,9 @@
 #include <str/strconv.hpp>
 
 // STL
+#include <deque>			//< for std::deque
 #include <filesystem>	//< for std::filesystem
+#include <iomanip>		//< for std::setw, std::setprecision
 #include <iostream>		//< for standard io streams
 
 // Global defaults
@@ -47,10 +59,23 @@ struct print_help {
 			<< "  -H, --host <Host>           RCON Server IP/Hostname.  (Default: \"" << DEFAULT_TARGET_HOST << "\")" << '\n'
 			<< "  -P, --port <Port>           RCON Server Port.         (Default: \"" << DEFAULT_TARGET_PORT << "\")" << '\n'
 			<< "  -p, --pass <Pass>           RCON Server Password.     (Default: \"\")" << '\n'
+			<< "      --response-end <Mode>   How the end of each response is detected; saved with \"--save\". (Default: \"terminator\")" << '\n'
+			<< "                              Modes: terminator, size[:<ms>], idle[:<ms>], single" << '\n'
+			<< "      --dialect <Dialect>     How commands that are too large for a single packet are split; saved with \"--save\". (Default: \"none\")" << '\n'
+			<< "                              Dialects: none (never split), source (at ';'), minecraft (repeats \"--split-prefix\")" << '\n'
+			<< "      --split-prefix <words>  The words repeated before each part of a split Minecraft command, e.g. \"say\". Oversized" << '\n'
+			<< "                               commands must start with them, and aren't split when this isn't set." << '\n'
 			<< "  -R, --recall <Name>         Recalls saved [Host|Port|Pass] values from the hosts file." << '\n'
 			<< "      --save   <Name>         Saves the specified [Host|Port|Pass] as \"<Name>\" in the hosts file." << '\n'
 			<< "      --remove <Name>         Removes an entry from the hosts file." << '\n'
 			<< "  -l, --list                  Lists the servers currently saved in the host file." << '\n'
+			<< "      --fanout <Names|all>    Sends the commands to each of the specified (comma-separated) saved hosts, or all of them." << '\n'
+			<< "      --fanout-limit <n>      Sets the maximum number of hosts to communicate with at once in fanout mode. Default: 16" << '\n'
+			<< "      --fanout-output <mode>  Sets how fanout output is shown; \"group\" (per host) or \"prefix\" (per line). Default: group" << '\n'
+			<< "      --bench <count>         Benchmarks the target by sending the commands in a loop until <count> have been sent, then" << '\n'
+			<< "                               prints the throughput, error count, and latency percentiles of each second." << '\n'
+			<< "      --bench-connections <n> Sets the number of connections to send benchmark commands over at once. Default: 1" << '\n'
+			<< "      --bench-rate <cmds/sec> Sends benchmark commands at a fixed rate instead of as fast as possible. Default: 0 (unlimited)" << '\n'
 			<< '\n'
 			<< "OPTIONS:\n"
 			<< "  -h, --help                  Shows this help display, then exits." << '\n'
@@ -58,16 +83,37 @@ struct print_help {
 			<< "  -q, --quiet                 Silent/Quiet mode; prevents or minimizes console output. Use \"-qn\" for scripts." << '\n'
 			<< "  -i, --interactive           Starts an interactive command shell after sending any scripted commands." << '\n'
 			<< "  -e, --echo                  Enables command echo in oneshot mode." << '\n'
-			<< "  -w, --wait <ms>             Sets the number of milliseconds to wait between sending each queued command. Default: 0" << '\n'
-			<< "  -t, --timeout <ms>          Sets the number of milliseconds to wait for a response before timing out. Default: 3000" << '\n'
+			<< "      --format <format>       Sets the output format of oneshot & fanout mode; \"text\", or \"ndjson\" for one JSON object per" << '\n'
+			<< "                               command with the target, command, response, byte & packet counts, and timings. Default: text" << '\n'
+			<< "  -w, --wait <ms>             Sets the minimum number of milliseconds between sending each queued command. Default: 0" << '\n'
+			<< "      --rate <cmds/sec>[:<n>] Limits the rate that commands are sent at, allowing up to <n> to be sent at once after a pause." << '\n'
+			<< "                               Time spent waiting for a response counts towards the next command. Overrides \"--wait\"." << '\n'
+			<< "      --rate-adaptive         Lowers the rate while response latency is elevated, then raises it back up as it recovers." << '\n'
+			<< "  -f, --file <file>           Load the specified file and run each line as a command. Lines starting with ';' or '#' are" << '\n'
+			<< "                               comments. The commands are sent before commands from STDIN & the commandline." << '\n'
+			<< "  -t, --timeout <ms>          Sets the default number of milliseconds that each operation may take before timing out. Default: 3000" << '\n'
+			<< "      --connect-timeout <ms>  Sets the number of milliseconds that DNS resolution & connecting may take. Default: (--timeout)" << '\n'
+			<< "      --auth-timeout <ms>     Sets the number of milliseconds that authentication may take. Default: (--timeout)" << '\n'
+			<< "      --command-timeout <ms>  Sets the number of milliseconds to wait for each command's complete response. Default: (--timeout)" << '\n'
+			<< "      --connect-delay <ms>    Sets the number of milliseconds to wait before trying the next resolved address. Default: 250" << '\n'
+			<< "      --pipeline <depth>      Sets the number of queued commands that may await a response at once. Default: 1" << '\n'
+			<< "      --dns-ttl <seconds>     Sets the number of seconds that resolved hostnames are cached for. Default: 300" << '\n'
+			<< "      --no-dns-cache          Disables the DNS cache, and always resolves the target hostname." << '\n'
 			<< "  -n, --no-color              Disables colorized console output." << '\n'
 			<< "  -Q, --no-prompt             Disables the prompt in interactive mode." << '\n'
 			<< "      --no-exit               Disables handling the \"exit\" keyword in interactive mode." << '\n'
 			<< "      --allow-empty           Enables sending empty (whitespace-only) commands to the server in interactive mode." << '\n'
 			<< "      --print-env             Prints all recognized environment variables, their values, and descriptions." << '\n'
+			<< "      --trace-startup         Prints the time spent in each phase of startup to STDERR before sending commands." << '\n'
+			<< "      --log-level <level>     Sets the lowest level of messages written to the log file; \"trace\", \"debug\", \"info\"," << '\n'
+			<< "                               \"warning\", \"error\", \"critical\", or \"fatal\". Default: trace" << '\n'
+			<< "      --stats                 Prints per-phase latency percentiles and traffic counters to STDERR when finished." << '\n'
+			<< "      --stats-json <file>     Writes per-phase latency percentiles and traffic counters to a JSON file. (\"-\" for STDOUT)" << '\n'
+			<< "      --daemon                Runs a daemon that keeps connections open for use by other instances with \"--use-daemon\"." << '\n'
+			<< "      --use-daemon            Sends commands through the daemon when it is running, instead of connecting directly." << '\n'
+			<< "      --daemon-socket <path>  Overrides the location of the daemon's local socket." << '\n'
 			//	<< "      --write-ini             (Over)write the INI file with the default configuration values & exit." << '\n'
 			//	<< "      --update-ini            Writes the current configuration values to the INI file, and adds missing keys." << '\n'
-			//	<< "  -f, --file <file>           Load the specified file and run each line as a command." << '\n'
 			;
 	}
 };
@@ -92,6 +138,8 @@ int main(const int argc, char** argv)
 
 int main_impl(const int argc, char** argv)
 {
+	StartupTrace startupTrace{ std::cerr };
+
 	const opt3::ArgManager args{ argc, argv,
 		// define capturing args:
 		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'H', "host", "hostname"),
@@ -99,31 +147,66 @@ int main_impl(const int argc, char** argv)
 		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'p', "pass", "password"),
 		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'S', 'R', "saved", "recall"),
 		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "save", "save-host"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "response-end"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "dialect"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "split-prefix"),
 		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "rm", "remove", "rm-host" "remove-host"),
 		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'w', "wait"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "rate"),
 		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 't', "timeout"),
 		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'f', "file"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "connect-timeout"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "connect-delay"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "auth-timeout"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "command-timeout"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "pipeline"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "dns-ttl"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "fanout"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "fanout-limit"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "fanout-output"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "bench"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "bench-connections"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "bench-rate"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "stats-json"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "daemon-socket"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "log-level"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "format"),
 	};
 
-	// get the executable's location & name
-	const auto& [programPath, programName] { env::PATH().resolve_split(argv[0]) };
-	FileLocator locator{ programPath, std::filesystem::path{ programName }.replace_extension() };
+	startupTrace.mark("parse arguments");
+	// --trace-startup
+	startupTrace.enable(args.check<opt3::Option>("trace-startup"));
+
+	// get the executable's name
+	const std::filesystem::path programName{ std::filesystem::path{ argv[0] }.filename() };
+	// the executable's location is only resolved when a config file is first needed, since that may require searching the PATH
+	const auto getLocator{ [argv]() -> FileLocator const& {
+		static const FileLocator locator{ [argv] {
+			const auto& [programPath, programName] { env::PATH().resolve_split(argv[0]) };
+			return FileLocator{ programPath, std::filesystem::path{ programName }.replace_extension() };
+		}() };
+		return locator;
+	} };
 
 	/// setup the log
-	// log file stream
-	std::ofstream logfs{ locator.from_extension(".log") };
+	// --log-level
+	if (const auto& arg_logLevel{ args.getv_any<opt3::Option>("log-level") }; arg_logLevel.has_value())
+		log_level = parse_log_level(arg_logLevel.value());
+	// log file, which is only created when the first message is written to it
+	LazyFileBuffer logfile{ [&getLocator, isDaemon = args.check<opt3::Option>("daemon")] { return getLocator().from_extension(isDaemon ? ".daemon.log" : ".log"); }, Logger::get_header() };
 	// log manager object
-	Logger logManager{ logfs.rdbuf() };
-	logManager.print_header();
+	Logger logManager{ &logfile };
 	// write commandline to log
-	{
+	if (is_log_enabled(LogLevel::Debug)) {
 		const auto argVec{ opt3::vectorize(argc, argv) };
-		std::clog
-			<< MessageHeader(LogLevel::Debug) << "Commandline Arguments: \""
+		ARRCON_LOG(LogLevel::Debug)
+			<< "Commandline Arguments: \""
 			<< str::stringify_join(argVec.begin(), argVec.end(), ' ') << '\"'
 			<< std::endl;
 	}
 
+	startupTrace.mark("set up logging");
+
 	try {
 		// -h|--help
 		if (args.empty() || args.check_any<opt3::Flag, opt3::Option>('h', "help")) {
@@ -188,8 +271,10 @@ int main_impl(const int argc, char** argv)
 		}
 
 		/// determine the target server info & operate on the hosts file
-		const auto hostsfile_path{ locator.from_extension(".hosts") };
+		const auto hostsfile_path{ getLocator().from_extension(".hosts") };
 		std::optional<config::SavedHosts> hostsfile;
+		// saved hosts are looked up in the index of the hosts file, which is rebuilt when the hosts file changes
+		std::optional<config::HostsIndex> hostsIndex;
 
 		// --remove|--rm|--rm-host|--remove-host
 		if (const auto& arg_removeHost{ args.getv_any<opt3::Option>("rm", "remove", "rm-host", "remove-host") }; arg_removeHost.has_value()) {
@@ -206,6 +291,7 @@ int main_impl(const int argc, char** argv)
 
 			// save the hosts file
 			if (ini.write(hostsfile_path)) {
+				config::HostsIndex::update(hostsfile_path, config::SavedHosts{ ini });
 				std::cout
 					<< "Successfully removed \"" << csync(color::yellow) << arg_removeHost.value() << csync() << "\" from the hosts list.\n"
 					<< "Saved hosts file to " << hostsfile_path << '\n'
@@ -220,28 +306,30 @@ int main_impl(const int argc, char** argv)
 				throw make_exception("The hosts file hasn't been created yet. (Use \"--save-host\" to create one)");
 
 			// load the hosts file
-			if (!hostsfile.has_value())
-				hostsfile = config::SavedHosts(hostsfile_path);
+			if (!hostsIndex.has_value())
+				hostsIndex.emplace(hostsfile_path);
 
-			if (hostsfile->empty())
+			if (hostsIndex->empty())
 				throw make_exception("The hosts file doesn't have any entries yet. (Use \"--save-host\" to create one)");
 
 			// if quiet was specified, get the length of the longest saved host name
 			size_t longestNameLength{};
 			if (quiet) {
-				for (const auto& [name, _] : *hostsfile) {
+				for (const auto& [name, _] : *hostsIndex) {
 					if (name.size() > longestNameLength)
 						longestNameLength = name.size();
 				}
 			}
 
 			// print out the hosts list
-			for (const auto& [name, info] : *hostsfile) {
+			for (const auto& [name, info] : *hostsIndex) {
 				if (!quiet) {
 					std::cout
 						<< csync(color::yellow) << name << csync() << '\n'
 						<< "    Hostname:  \"" << info.host << "\"\n"
 						<< "    Port:      \"" << info.port << "\"\n"
+						<< "    Response:  \"" << info.responseEnd << "\"\n"
+						<< "    Dialect:   \"" << info.dialect << "\"\n"
 						;
 				}
 				else {
@@ -256,6 +344,27 @@ int main_impl(const int argc, char** argv)
 			return 0;
 		}
 
+		// --daemon-socket
+		const std::filesystem::path daemonSocketPath{ args.getv_any<opt3::Option>("daemon-socket").value_or(getLocator().from_extension(".sock").string()) };
+
+		// --daemon
+		if (args.check<opt3::Option>("daemon")) {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+			// the timeouts of each request are chosen by the instance that sent it
+			if (args.check_any<opt3::Flag, opt3::Option>('t', "timeout", "connect-timeout", "connect-delay", "auth-timeout", "command-timeout"))
+				throw make_exception("The daemon uses the timeouts of each request; specify them on the instances that use \"--use-daemon\" instead!");
+
+			net::daemon::DaemonServer daemon{ daemonSocketPath };
+			if (!quiet)
+				std::cout << "Daemon is listening on " << daemonSocketPath << ".\nUse <Ctrl + C> to stop it.\n";
+
+			daemon.run();
+			return 0;
+#else
+			throw make_exception("Daemon mode isn't supported on this platform!");
+#endif
+		}
+
 		net::rcon::target_info target{
 			env::getvar(programNameStr + "_HOST").value_or(DEFAULT_TARGET_HOST),
 			env::getvar(programNameStr + "_PORT").value_or(DEFAULT_TARGET_PORT),
@@ -268,16 +377,16 @@ int main_impl(const int argc, char** argv)
 				throw make_exception("The hosts file hasn't been created yet. (Use \"--save\" to create one)");
 
 			// load the hosts file
-			if (!hostsfile.has_value())
-				hostsfile = config::SavedHosts(hostsfile_path);
+			if (!hostsIndex.has_value())
+				hostsIndex.emplace(hostsfile_path);
 
 			// try getting the specified saved target's info
-			if (const auto savedTarget{ hostsfile->get_host(arg_saved.value()) }; savedTarget.has_value()) {
+			if (const auto savedTarget{ hostsIndex->get_host(arg_saved.value()) }; savedTarget.has_value()) {
 				target = savedTarget.value();
 			}
 			else throw make_exception("The specified saved host \"", arg_saved.value(), "\" doesn't exist! (Use \"--list\" to see a list of saved hosts)");
 
-			std::clog << MessageHeader(LogLevel::Debug) << "Recalled saved host information for \"" << arg_saved.value() << "\": " << target << std::endl;
+			ARRCON_LOG(LogLevel::Debug) << "Recalled saved host information for \"" << arg_saved.value() << "\": " << target << std::endl;
 		}
 		// -H|--host|--hostname
 		if (const auto& arg_hostname{ args.getv_any<opt3::Flag, opt3::Option>('H', "host", "hostname") }; arg_hostname.has_value())
@@ -288,6 +397,20 @@ int main_impl(const int argc, char** argv)
 		// -p|--pass|--password
 		if (const auto& arg_password{ args.getv_any<opt3::Flag, opt3::Option>('p', "pass", "password") }; arg_password.has_value())
 			target.pass = arg_password.value();
+		// --response-end
+		if (const auto& arg_responseEnd{ args.getv_any<opt3::Option>("response-end") }; arg_responseEnd.has_value()) {
+			if (const auto strategy{ net::rcon::response_end_strategy::parse(arg_responseEnd.value()) }; strategy.has_value())
+				target.responseEnd = strategy.value();
+			else throw make_exception("Invalid response end strategy \"", arg_responseEnd.value(), "\"; expected terminator, size[:<ms>], idle[:<ms>], or single!");
+		}
+		// --dialect
+		if (const auto& arg_dialect{ args.getv_any<opt3::Option>("dialect") }; arg_dialect.has_value()) {
+			if (const auto dialect{ net::rcon::parse_dialect(arg_dialect.value()) }; dialect.has_value())
+				target.dialect = dialect.value();
+			else throw make_exception("Invalid dialect \"", arg_dialect.value(), "\"; expected none, source, or minecraft!");
+		}
+		// --split-prefix
+		const std::string splitPrefix{ args.getv_any<opt3::Option>("split-prefix").value_or("") };
 
 		// --save|--save-host
 		if (const auto& arg_saveHost{ args.getv_any<opt3::Option>("save", "save-host") }; arg_saveHost.has_value()) {
@@ -318,6 +441,7 @@ int main_impl(const int argc, char** argv)
 			ini::INI ini;
 			hostsfile->export_to(ini);
 			if (ini.write(hostsfile_path)) {
+				config::HostsIndex::update(hostsfile_path, *hostsfile);
 				std::cout
 					<< "Host \"" << csync(color::yellow) << arg_saveHost.value() << csync() << "\" was " << (exists ? "updated" : "created") << " with the specified server info.\n"
 					<< "Saved hosts file to " << hostsfile_path << '\n'
@@ -327,72 +451,437 @@ int main_impl(const int argc, char** argv)
 			else throw make_exception("Failed to save hosts file to ", hostsfile_path, '!');
 		}
 
-		// initialize the client
-		net::rcon::RconClient client;
+		startupTrace.mark("determine target");
 
-		// connect to the server
-		client.connect(target.host, target.port);
+		// --no-dns-cache & --dns-ttl
+		std::optional<net::DnsCache> dnsCache;
+		if (!args.check<opt3::Option>("no-dns-cache")) {
+			const auto dnsTTL{ args.castgetv_any<int64_t, opt3::Option>([](auto&& arg) { return str::tonumber<int64_t>(std::forward<decltype(arg)>(arg)); }, "dns-ttl").value_or(net::DnsCache::DEFAULT_TTL) };
+			dnsCache.emplace(getLocator().from_extension(".dnscache"), std::chrono::seconds{ dnsTTL });
+		}
 
-		// -t|--timeout
-		client.set_timeout(args.castgetv_any<int, opt3::Flag, opt3::Option>([](auto&& arg) { return str::stoi(std::forward<decltype(arg)>(arg)); }, 't', "timeout").value_or(3000));
-		// ^ this needs to be set AFTER connecting
+		// resolve the target in the background while the rest of the arguments are processed, unless it is cached or isn't a hostname
+		std::optional<net::BackgroundResolver> backgroundResolver;
+		if (!args.check_any<opt3::Option>("fanout", "bench", "use-daemon")
+			&& net::DnsCache::is_cacheable(target.host)
+			&& !(dnsCache && dnsCache->get(target.host, target.port).has_value()))
+			backgroundResolver.emplace(target.host, target.port);
 
-		// authenticate with the server
-		if (!client.authenticate(target.pass)) {
-			throw ExceptionBuilder()
-				.line("Authentication Error:  Incorrect Password!")
-				.line("Target Hostname/IP:    ", target.host)
-				.line("Target Port:           ", target.port)
-				.line("Suggested Solutions:")
-				.line("1.  Verify the password you entered is correct.")
-				.line("2.  Make sure this is the correct target.")
-				.build();
-		}
+		startupTrace.mark("start DNS resolution");
 
-		/// get commands from STDIN & the commandline
+		/// get commands from the script file, STDIN & the commandline
 		std::vector<std::string> commands;
+		// commands from the script file & STDIN are sent as they are read in oneshot mode; the other modes need all of the commands up front
+		const bool streamCommands{ !args.check_any<opt3::Option>("fanout", "bench", "use-daemon") };
+		// -f|--file
+		std::optional<ScriptFile> script;
+		if (const auto arg_file{ args.getv_any<opt3::Flag, opt3::Option>('f', "file") }; arg_file.has_value()) {
+			script.emplace(arg_file.value());
+			if (!streamCommands) {
+				commands = script->read_all();
+				script.reset();
+			}
+		}
+		std::optional<LineReader> stdinLines;
 		if (hasPendingDataSTDIN()) {
-			// get commands from STDIN
-			for (std::string buf; std::getline(std::cin, buf);) {
-				commands.emplace_back(buf);
+			if (streamCommands)
+				stdinLines.emplace(std::cin);
+			else {
+				// get commands from STDIN
+				for (std::string buf; std::getline(std::cin, buf);) {
+					commands.emplace_back(buf);
+				}
 			}
 		}
 		if (const auto parameters{ args.getv_all<opt3::Parameter>() };
 			!parameters.empty()) {
 			commands.insert(commands.end(), parameters.begin(), parameters.end());
 		}
+		// provides views of the commands from the script file, then STDIN, then the commandline
+		//  script file commands view the mapped file and commandline commands view the vector, so neither is copied;
+		//  lines from STDIN are kept here until their response has been received
+		std::deque<std::string> stdinCommands;
+		size_t nextParameter{ 0 };
+		const auto nextCommand{ [&](std::string_view& command, bool const wait) {
+			if (script.has_value() && script->next(command)) //< the mapping is kept until exit, since commands view it
+				return net::rcon::NextCommand::Ready;
+			if (stdinLines.has_value()) {
+				if (std::string line; wait ? stdinLines->pop(line) : stdinLines->try_pop(line)) {
+					command = stdinCommands.emplace_back(std::move(line));
+					return net::rcon::NextCommand::Ready;
+				}
+				if (!wait && !stdinLines->done())
+					return net::rcon::NextCommand::Pending;
+				stdinLines.reset(); //< reached the end of STDIN
+			}
+			if (nextParameter < commands.size()) {
+				command = commands[nextParameter++];
+				return net::rcon::NextCommand::Ready;
+			}
+			return net::rcon::NextCommand::Done;
+		} };
+		// releases a command once its response has been received; commands are released in the order they were provided
+		const auto releaseCommand{ [&stdinCommands](std::string_view const command) {
+			if (!stdinCommands.empty() && stdinCommands.front().data() == command.data())
+				stdinCommands.pop_front();
+		} };
+		const bool hasCommands{ script.has_value() || stdinLines.has_value() || !commands.empty() };
+
+		startupTrace.mark("read commands");
 
 		const bool noPrompt{ args.check_any<opt3::Flag, opt3::Option>('Q', "no-prompt") };
 		const bool echoCommands{ args.check_any<opt3::Flag, opt3::Option>('e', "echo") };
 
-		// Oneshot Mode
-		if (!commands.empty()) {
-			// get the command delay, if one was specified
-			std::chrono::milliseconds commandDelay;
-			bool useCommandDelay{ false };
-			if (const auto waitArg{ args.getv_any<opt3::Flag, opt3::Option>('w', "wait") }; waitArg.has_value()) {
-				commandDelay = std::chrono::milliseconds{ str::tonumber<uint64_t>(waitArg.value()) };
-				useCommandDelay = true;
+		// --format
+		const auto outputFormat{ args.getv_any<opt3::Option>("format").value_or("text") };
+		if (!str::equalsAny<false>(outputFormat, "text", "ndjson"))
+			throw make_exception("Invalid output format \"", outputFormat, "\"; expected \"text\" or \"ndjson\"!");
+		std::optional<NdjsonWriter> ndjson;
+		if (str::equalsAny<false>(outputFormat, "ndjson"))
+			ndjson.emplace(std::cout);
+		const std::string targetName{ str::stringify(target.host, ':', target.port) };
+
+		// -t|--timeout
+		const int timeout_ms{ args.castgetv_any<int, opt3::Flag, opt3::Option>([](auto&& arg) { return str::stoi(std::forward<decltype(arg)>(arg)); }, 't', "timeout").value_or(3000) };
+		// --connect-timeout & --connect-delay
+		const int connect_timeout_ms{ args.castgetv_any<int, opt3::Option>([](auto&& arg) { return str::stoi(std::forward<decltype(arg)>(arg)); }, "connect-timeout").value_or(timeout_ms) };
+		const int connect_delay_ms{ args.castgetv_any<int, opt3::Option>([](auto&& arg) { return str::stoi(std::forward<decltype(arg)>(arg)); }, "connect-delay").value_or(250) };
+		// --auth-timeout & --command-timeout
+		const int auth_timeout_ms{ args.castgetv_any<int, opt3::Option>([](auto&& arg) { return str::stoi(std::forward<decltype(arg)>(arg)); }, "auth-timeout").value_or(timeout_ms) };
+		const int command_timeout_ms{ args.castgetv_any<int, opt3::Option>([](auto&& arg) { return str::stoi(std::forward<decltype(arg)>(arg)); }, "command-timeout").value_or(timeout_ms) };
+
+		// --pipeline
+		const size_t pipelineDepth{ args.castgetv_any<size_t, opt3::Option>([](auto&& arg) { return str::tonumber<size_t>(std::forward<decltype(arg)>(arg)); }, "pipeline").value_or(1) };
+		if (pipelineDepth == 0)
+			throw make_exception("Invalid pipeline depth \"0\"; the depth must be at least 1!");
+
+		// --rate & -w|--wait
+		std::optional<net::rcon::rate_limit> rateLimit;
+		if (const auto arg_rate{ args.getv_any<opt3::Option>("rate") }; arg_rate.has_value()) {
+			rateLimit = net::rcon::rate_limit::parse(arg_rate.value());
+			if (!rateLimit.has_value())
+				throw make_exception("Invalid rate \"", arg_rate.value(), "\"; expected <cmds/sec>[:<burst>], where the burst is at least 1!");
+		}
+		else if (const auto arg_wait{ args.getv_any<opt3::Flag, opt3::Option>('w', "wait") }; arg_wait.has_value()) {
+			// a fixed delay between commands is the same as a rate limit without any burst
+			if (const auto wait_ms{ str::tonumber<uint64_t>(arg_wait.value()) }; wait_ms > 0)
+				rateLimit = net::rcon::rate_limit{ 1000.0 / static_cast<double>(wait_ms), 1.0 };
+		}
+		// --rate-adaptive
+		if (args.check<opt3::Option>("rate-adaptive")) {
+			if (!rateLimit.has_value())
+				throw make_exception("\"--rate-adaptive\" requires a rate limit; specify one with \"--rate <cmds/sec>[:<burst>]\"!");
+			rateLimit->adaptive = true;
+		}
+		if (rateLimit.has_value())
+			ARRCON_LOG(LogLevel::Debug) << "Commands are limited to " << rateLimit.value() << " commands per second." << std::endl;
+
+		// --stats & --stats-json
+		const bool printStats{ args.check<opt3::Option>("stats") };
+		const auto statsJsonPath{ args.getv_any<opt3::Option>("stats-json") };
+		const auto reportStats{ [&](net::rcon::client_stats const& stats) {
+			if (printStats)
+				stats.print(std::cerr);
+			if (statsJsonPath.has_value()) {
+				if (statsJsonPath.value() == "-")
+					stats.print_json(std::cout);
+				else if (std::ofstream ofs{ statsJsonPath.value() }; ofs)
+					stats.print_json(ofs);
+				else throw make_exception("Failed to write statistics to \"", statsJsonPath.value(), "\"!");
 			}
+		} };
+
+		startupTrace.mark("read options");
 
-			// oneshot mode
-			bool fst{ true };
-			for (const auto& command : commands) {
-				// wait for the specified number of milliseconds
-				if (useCommandDelay) {
-					if (fst) fst = false;
-					else std::this_thread::sleep_for(commandDelay);
+		// --fanout
+		if (const auto& arg_fanout{ args.getv_any<opt3::Option>("fanout") }; arg_fanout.has_value()) {
+			startupTrace.report();
+			if (commands.empty())
+				throw make_exception("Fanout mode requires at least one command!");
+			if (!std::filesystem::exists(hostsfile_path))
+				throw make_exception("The hosts file hasn't been created yet. (Use \"--save\" to create one)");
+
+			// load the hosts file
+			if (!hostsIndex.has_value())
+				hostsIndex.emplace(hostsfile_path);
+
+			// get the list of targets
+			std::vector<net::rcon::named_target> targets;
+			if (arg_fanout.value() == "all") {
+				targets.reserve(hostsIndex->size());
+				for (auto&& [name, info] : *hostsIndex) {
+					targets.emplace_back(name, std::move(info));
+				}
+			}
+			else {
+				const std::string_view names{ arg_fanout.value() };
+				for (size_t pos{ 0 }, end{ 0 }; pos <= names.size(); pos = end + 1) {
+					if (end = names.find(',', pos); end == std::string_view::npos)
+						end = names.size();
+
+					const auto name{ str::trim(std::string{ names.substr(pos, end - pos) }) };
+					if (name.empty()) continue;
+
+					if (const auto savedTarget{ hostsIndex->get_host(name) }; savedTarget.has_value())
+						targets.emplace_back(name, savedTarget.value());
+					else throw make_exception("The specified saved host \"", name, "\" doesn't exist! (Use \"--list\" to see a list of saved hosts)");
 				}
+			}
+			if (targets.empty())
+				throw make_exception("No saved hosts were specified for fanout mode!");
+
+			// --fanout-output
+			const auto outputMode{ args.getv_any<opt3::Option>("fanout-output").value_or("group") };
+			if (!str::equalsAny<false>(outputMode, "group", "prefix"))
+				throw make_exception("Invalid fanout output mode \"", outputMode, "\"; expected \"group\" or \"prefix\"!");
+			const bool prefixOutput{ str::equalsAny<false>(outputMode, "prefix") };
+
+			net::rcon::fanout_settings settings;
+			// --fanout-limit
+			settings.concurrency = args.castgetv_any<size_t, opt3::Option>([](auto&& arg) { return str::tonumber<size_t>(std::forward<decltype(arg)>(arg)); }, "fanout-limit").value_or(settings.concurrency);
+			settings.pipelineDepth = pipelineDepth;
+			settings.connect_timeout_ms = connect_timeout_ms;
+			settings.connect_delay_ms = connect_delay_ms;
+			settings.auth_timeout_ms = auth_timeout_ms;
+			settings.command_timeout_ms = command_timeout_ms;
+			settings.rateLimit = rateLimit;
+			settings.splitPrefix = splitPrefix;
+			settings.dnsCache = dnsCache ? &*dnsCache : nullptr;
+			net::rcon::client_stats stats;
+			settings.stats = &stats;
+
+			// responses are held until each target is finished when output is grouped
+			std::vector<std::vector<std::string>> responses(prefixOutput ? 0 : targets.size());
+
+			const auto failedCount{ net::rcon::fanout(targets, commands, settings,
+				[&](size_t targetIndex, size_t commandIndex, std::string&& response, net::rcon::response_info const& info) {
+					if (ndjson) {
+						ndjson->record(targets[targetIndex].first, commands[commandIndex], response, &info);
+						return;
+					}
+					if (!prefixOutput) {
+						responses[targetIndex].emplace_back(std::move(response));
+						return;
+					}
+
+					// print each line of the response prefixed with the target's name
+					const auto& name{ targets[targetIndex].first };
+					if (echoCommands)
+						std::cout << csync(color::yellow) << '[' << name << ']' << csync() << ' ' << commands[commandIndex] << '\n';
+					const std::string trimmed{ str::trim(response) };
+					for (size_t pos{ 0 }, end{ 0 }; pos < trimmed.size(); pos = end + 1) {
+						if (end = trimmed.find('\n', pos); end == std::string::npos)
+							end = trimmed.size();
+						std::cout << csync(color::yellow) << '[' << name << ']' << csync() << ' ' << std::string_view{ trimmed }.substr(pos, end - pos) << '\n';
+					}
+					std::cout.flush();
+				},
+				[&](size_t targetIndex, std::exception_ptr error) {
+					const auto& name{ targets[targetIndex].first };
+
+					if (!ndjson && !prefixOutput) {
+						// print the target's responses as a group
+						std::cout << csync(color::yellow) << name << csync() << '\n';
+						for (size_t i{ 0 }; i < responses[targetIndex].size(); ++i) {
+							if (echoCommands) {
+								if (!noPrompt) // print the shell prompt
+									print_input_prompt(std::cout, targets[targetIndex].second.host, csync);
+								// echo the command
+								std::cout << commands[i] << '\n';
+							}
+							std::cout << str::trim(responses[targetIndex][i]) << '\n';
+						}
+						responses[targetIndex].clear();
+						std::cout.flush();
+					}
+
+					if (error) {
+						try {
+							std::rethrow_exception(error);
+						} catch (std::exception const& ex) {
+							if (ndjson)
+								ndjson->error(name, {}, ex.what());
+							std::cerr << csync(color::red) << '[' << name << ']' << csync() << ' ' << ex.what() << std::endl;
+						}
+					}
+				}) };
+
+			reportStats(stats);
+
+			return failedCount == 0 ? 0 : 1;
+		}
 
+		// --bench
+		if (const auto& arg_bench{ args.getv_any<opt3::Option>("bench") }; arg_bench.has_value()) {
+			startupTrace.report();
+			if (commands.empty())
+				throw make_exception("Benchmark mode requires at least one command!");
+
+			net::rcon::bench_settings settings;
+			settings.count = str::tonumber<size_t>(arg_bench.value());
+			// --bench-connections
+			settings.connections = args.castgetv_any<size_t, opt3::Option>([](auto&& arg) { return str::tonumber<size_t>(std::forward<decltype(arg)>(arg)); }, "bench-connections").value_or(settings.connections);
+			// --bench-rate
+			settings.rate = args.castgetv_any<double, opt3::Option>([](auto&& arg) { return str::tonumber<double>(std::forward<decltype(arg)>(arg)); }, "bench-rate").value_or(settings.rate);
+			settings.connect_timeout_ms = connect_timeout_ms;
+			settings.connect_delay_ms = connect_delay_ms;
+			settings.auth_timeout_ms = auth_timeout_ms;
+			settings.command_timeout_ms = command_timeout_ms;
+			settings.splitPrefix = splitPrefix;
+			settings.dnsCache = dnsCache ? &*dnsCache : nullptr;
+			net::rcon::client_stats stats;
+			settings.stats = &stats;
+
+			const auto ms{ [](uint64_t const us) { return static_cast<double>(us) / 1000.0; } };
+			const auto printResults{ [&](net::rcon::bench_results const& results) {
+				std::cout
+					<< std::fixed << std::setprecision(1)
+					<< '[' << std::setw(7) << std::chrono::duration<double>(results.elapsed).count() << "s]"
+					<< std::setprecision(0)
+					<< std::setw(10) << results.throughput() << " cmds/sec"
+					<< std::setw(8) << results.completed << " ok"
+					<< std::setw(6) << results.errors << " errors"
+					<< std::setprecision(3)
+					<< "   p50 " << ms(results.latency.percentile(50)) << "ms"
+					<< "   p90 " << ms(results.latency.percentile(90)) << "ms"
+					<< "   p99 " << ms(results.latency.percentile(99)) << "ms"
+					<< "   max " << ms(results.latency.max()) << "ms"
+					<< std::defaultfloat << std::endl;
+			} };
+
+			const auto results{ net::rcon::bench(target, commands, settings, printResults) };
+
+			std::cout << csync(color::yellow) << "Total" << csync() << ' ';
+			printResults(results);
+
+			reportStats(stats);
+
+			return results.errors == 0 ? 0 : 1;
+		}
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		// --use-daemon
+		if (!commands.empty() && args.check<opt3::Option>("use-daemon") && !args.check_any<opt3::Flag, opt3::Option>('i', "interactive")) {
+			startupTrace.report();
+			const net::daemon::request_timeouts timeouts{ connect_timeout_ms, connect_delay_ms, auth_timeout_ms, command_timeout_ms };
+			const bool sent{ net::daemon::send_via_daemon(daemonSocketPath, target, splitPrefix, timeouts, commands, [&](size_t index, std::string_view response) {
+				if (ndjson) {
+					// the daemon doesn't report packet counts or timings
+					ndjson->record(targetName, commands[index], response, nullptr);
+					return;
+				}
 				if (echoCommands) {
 					if (!noPrompt) // print the shell prompt
 						print_input_prompt(std::cout, target.host, csync);
 					// echo the command
-					std::cout << command << '\n';
+					std::cout << commands[index] << '\n';
 				}
 
-				// execute the command and print the result
-				std::cout << str::trim(client.command(command)) << std::endl;
+				// print the result
+				std::cout << str::trim(std::string{ response }) << std::endl;
+			}) };
+			if (sent)
+				return 0;
+
+			// the daemon isn't running or didn't accept the request, so none of the commands were executed
+			ARRCON_LOG(LogLevel::Warning) << "Couldn't send the commands through the daemon; connecting to the target directly." << std::endl;
+		}
+#endif
+
+		// initialize the client
+		net::rcon::RconClient client;
+
+		client.set_connect_timeout(connect_timeout_ms);
+		client.set_connect_attempt_delay(connect_delay_ms);
+		client.set_auth_timeout(auth_timeout_ms);
+		client.set_command_timeout(command_timeout_ms);
+		client.set_response_end(target.responseEnd);
+		client.set_dialect(target.dialect);
+		client.set_split_prefix(splitPrefix);
+		client.set_dns_cache(dnsCache ? &*dnsCache : nullptr);
+		client.set_background_resolver(backgroundResolver ? &*backgroundResolver : nullptr);
+		std::optional<net::rcon::rate_limiter> rateLimiter;
+		if (rateLimit.has_value())
+			rateLimiter.emplace(rateLimit.value());
+		client.set_rate_limiter(rateLimiter ? &*rateLimiter : nullptr);
+
+		// connect to the server
+		client.connect(target.host, target.port);
+		startupTrace.mark("resolve & connect");
+
+		// authenticate with the server
+		if (!client.authenticate(target.pass)) {
+			throw ExceptionBuilder()
+				.line("Authentication Error:  Incorrect Password!")
+				.line("Target Hostname/IP:    ", target.host)
+				.line("Target Port:           ", target.port)
+				.line("Suggested Solutions:")
+				.line("1.  Verify the password you entered is correct.")
+				.line("2.  Make sure this is the correct target.")
+				.build();
+		}
+		startupTrace.mark("authenticate");
+		startupTrace.report();
+
+		// Oneshot Mode
+		if (hasCommands) {
+			if (pipelineDepth > 1) {
+				// pipelined oneshot mode
+				// the commands that are awaiting a response, in submission order
+				std::deque<std::string_view> inFlight;
+				client.command_pipelined([&](std::string_view& command, bool const wait) {
+					const auto state{ nextCommand(command, wait) };
+					if (state == net::rcon::NextCommand::Ready)
+						inFlight.emplace_back(command);
+					return state;
+				}, pipelineDepth, [&](size_t, std::string&& response, net::rcon::response_info const& info) {
+					const auto command{ inFlight.front() };
+					inFlight.pop_front();
+
+					if (ndjson)
+						ndjson->record(targetName, command, response, &info);
+					else {
+						if (echoCommands) {
+							if (!noPrompt) // print the shell prompt
+								print_input_prompt(std::cout, target.host, csync);
+							// echo the command
+							std::cout << command << '\n';
+						}
+
+						// print the result
+						std::cout << str::trim(response) << std::endl;
+					}
+					releaseCommand(command);
+				});
+			}
+			else {
+				// oneshot mode
+				for (std::string_view command; nextCommand(command, true) == net::rcon::NextCommand::Ready; releaseCommand(command)) {
+					if (ndjson) {
+						// write the response into the record as it is received
+						ndjson->begin(targetName, command);
+						try {
+							const auto info{ client.command(command, [&](std::string_view chunk) { ndjson->write(chunk); }) };
+							ndjson->end(&info);
+						} catch (std::exception const& ex) {
+							ndjson->fail(ex.what());
+							throw;
+						}
+						continue;
+					}
+
+					if (echoCommands) {
+						if (!noPrompt) // print the shell prompt
+							print_input_prompt(std::cout, target.host, csync);
+						// echo the command
+						std::cout << command << '\n';
+					}
+
+					// execute the command and print the result as it is received
+					TrimmedWriter output{ std::cout };
+					client.command(command, [&output](std::string_view chunk) { output.write(chunk); });
+					std::cout << std::endl;
+				}
 			}
 		}
 
@@ -400,7 +889,7 @@ int main_impl(const int argc, char** argv)
 		const bool allowEmptyCommands{ args.check_any<opt3::Option>("allow-empty") };
 
 		// Interactive mode
-		if (commands.empty() || args.check_any<opt3::Flag, opt3::Option>('i', "interactive")) {
+		if (!hasCommands || args.check_any<opt3::Flag, opt3::Option>('i', "interactive")) {
 			if (!noPrompt) {
 				std::cout << "Authentication Successful.\nUse <Ctrl + C>";
 				if (!disableExitKeyword) std::cout << " or type \"exit\"";
@@ -418,7 +907,7 @@ int main_impl(const int argc, char** argv)
 
 				// check for data remaining in the socket's buffer from previous commands
 				if (const auto& buffer_size{ client.buffer_size() }; buffer_size > 0) {
-					std::clog << MessageHeader(LogLevel::Warning) << "The buffer contains " << buffer_size << " unexpected bytes! Dumping the buffer to STDOUT." << std::endl;
+					ARRCON_LOG(LogLevel::Warning) << "The buffer contains " << buffer_size << " unexpected bytes! Dumping the buffer to STDOUT." << std::endl;
 
 					// print the buffered data before continuing
 					std::cout << str::trim(net::rcon::bytes_to_string(client.flush())) << std::endl;
@@ -433,27 +922,34 @@ int main_impl(const int argc, char** argv)
 				else if (!disableExitKeyword && str == "exit")
 					break; //< exit on keyword input
 
-				// send the command and get the response
-				str = str::trim(client.command(str));
-
-				if (str.empty()) {
+				// send the command and print the response as it is received
+				TrimmedWriter output{ std::cout };
+				mc_color::color_code_translator colorCodes;
+				std::string translated;
+				client.command(str, [&](std::string_view chunk) {
+					// replace minecraft bukkit color codes with ANSI sequences
+					translated.clear();
+					colorCodes.translate(chunk, translated);
+					output.write(translated);
+				});
+				translated.clear();
+				colorCodes.finish(translated);
+				output.write(translated);
+
+				if (output.empty()) {
 					// response is empty
 					std::cerr << csync(color::orange) << "[empty response]" << csync() << '\n';
 				}
-				else {
-					// replace minecraft bukkit color codes with ANSI sequences
-					str = mc_color::replace_color_codes(str);
-
-					// print the response
-					std::cout << str << std::endl;
-				}
+				else std::cout << std::endl;
 			}
 		}
 
+		reportStats(client.get_stats());
+
 		return 0;
 	} catch (std::exception const& ex) {
 		// catch & log exceptions
-		std::clog << MessageHeader(LogLevel::Fatal) << ex.what() << std::endl;
+		ARRCON_LOG(LogLevel::Fatal) << ex.what() << std::endl;
 		throw; //< rethrow
 	}
 }
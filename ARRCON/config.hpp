@@ -39,7 +39,7 @@ namespace config {
 			if (ini.contains("")) {
 				// warn about global keys
 				const auto globalKeysCount{ ini.at("").size() };
-				std::clog << MessageHeader(LogLevel::Warning) << "Hosts file contains " << globalKeysCount << " key" << (globalKeysCount == 1 ? "" : "s") << " that aren't associated with a saved host!" << std::endl;
+				ARRCON_LOG(LogLevel::Warning) << "Hosts file contains " << globalKeysCount << " key" << (globalKeysCount == 1 ? "" : "s") << " that aren't associated with a saved host!" << std::endl;
 			}
 
 			// enumerate entries
@@ -51,20 +51,36 @@ namespace config {
 					if (str::equalsAny<false>(keyLower, "sHost")) {
 						hosts[entryKey].host = value;
 
-						std::clog << MessageHeader(LogLevel::Trace) << '[' << entryKey << ']' << " Imported hostname \"" << value << '\"' << std::endl;
+						ARRCON_LOG(LogLevel::Trace) << '[' << entryKey << ']' << " Imported hostname \"" << value << '\"' << std::endl;
 					}
 					else if (str::equalsAny<false>(keyLower, "sPort")) {
 						hosts[entryKey].port = value;
 
-						std::clog << MessageHeader(LogLevel::Trace) << '[' << entryKey << ']' << " Imported port \"" << value << '\"' << std::endl;
+						ARRCON_LOG(LogLevel::Trace) << '[' << entryKey << ']' << " Imported port \"" << value << '\"' << std::endl;
 					}
 					else if (str::equalsAny<false>(keyLower, "sPass")) {
 						hosts[entryKey].pass = value;
 
-						std::clog << MessageHeader(LogLevel::Trace) << '[' << entryKey << ']' << " Imported password \"" << std::string(value.size(), '*') << '\"' << std::endl;
+						ARRCON_LOG(LogLevel::Trace) << '[' << entryKey << ']' << " Imported password \"" << std::string(value.size(), '*') << '\"' << std::endl;
+					}
+					else if (str::equalsAny<false>(keyLower, "sResponseEnd")) {
+						if (const auto strategy{ net::rcon::response_end_strategy::parse(value) }; strategy.has_value()) {
+							hosts[entryKey].responseEnd = strategy.value();
+
+							ARRCON_LOG(LogLevel::Trace) << '[' << entryKey << ']' << " Imported response end strategy \"" << value << '\"' << std::endl;
+						}
+						else ARRCON_LOG(LogLevel::Warning) << '[' << entryKey << ']' << " Skipped invalid response end strategy \"" << value << "\"" << std::endl;
+					}
+					else if (str::equalsAny<false>(keyLower, "sDialect")) {
+						if (const auto dialect{ net::rcon::parse_dialect(value) }; dialect.has_value()) {
+							hosts[entryKey].dialect = dialect.value();
+
+							ARRCON_LOG(LogLevel::Trace) << '[' << entryKey << ']' << " Imported dialect \"" << value << '\"' << std::endl;
+						}
+						else ARRCON_LOG(LogLevel::Warning) << '[' << entryKey << ']' << " Skipped invalid dialect \"" << value << "\"" << std::endl;
 					}
 					else {
-						std::clog << MessageHeader(LogLevel::Warning) << '[' << entryKey << ']' << " Skipped unrecognized key \"" << key << "\"" << std::endl;
+						ARRCON_LOG(LogLevel::Warning) << '[' << entryKey << ']' << " Skipped unrecognized key \"" << key << "\"" << std::endl;
 					}
 				}
 			}
@@ -76,9 +92,11 @@ namespace config {
 					std::make_pair("sHost", info.host),
 					std::make_pair("sPort", info.port),
 					std::make_pair("sPass", info.pass),
+					std::make_pair("sResponseEnd", str::stringify(info.responseEnd)),
+					std::make_pair("sDialect", str::stringify(info.dialect)),
 				};
 
-				std::clog << MessageHeader(LogLevel::Trace) << '[' << name << ']' << " was exported successfully." << std::endl;
+				ARRCON_LOG(LogLevel::Trace) << '[' << name << ']' << " was exported successfully." << std::endl;
 			}
 		}
 
@@ -0,0 +1,117 @@
+#pragma once
+// STL
+#include <algorithm>			//< for std::max
+#include <condition_variable>	//< for std::condition_variable
+#include <deque>				//< for std::deque
+#include <istream>				//< for std::istream
+#include <memory>				//< for std::shared_ptr
+#include <mutex>				//< for std::mutex
+#include <string>				//< for std::string
+#include <thread>				//< for std::thread
+
+/**
+ * @class	LineReader
+ * @brief	Reads lines from an input stream on a background thread into a bounded queue, so they can be used as soon as they arrive.
+ *\n		When the queue is full the background thread stops reading until half of it has been taken, which applies backpressure
+ *			 to whatever is writing to the stream (e.g. the other end of a pipe) and keeps memory usage constant.
+ *			 Waking the thread in batches avoids a context switch for every line when the stream is faster than its consumer.
+ */
+class LineReader {
+	struct shared_state {
+		std::mutex mutex;
+		std::condition_variable notEmpty;
+		std::condition_variable notFull;
+		std::deque<std::string> lines;
+		size_t capacity;
+		bool eof{ false };
+		bool abandoned{ false };
+
+		shared_state(size_t const capacity) : capacity{ capacity } {}
+	};
+	// the background thread owns a reference to the state too, since it may still be blocked on the stream when the reader is destroyed
+	std::shared_ptr<shared_state> state;
+
+	/// @brief	Moves the first line out of the non-empty queue, then unlocks it & wakes the background thread once half of the queue is free.
+	void take(std::unique_lock<std::mutex>& lock, std::string& line)
+	{
+		line = std::move(state->lines.front());
+		state->lines.pop_front();
+		const bool halfFree{ state->lines.size() == state->capacity / 2 };
+		lock.unlock();
+		if (halfFree)
+			state->notFull.notify_one();
+	}
+
+public:
+	/// @brief	The default maximum number of lines that may be waiting in the queue.
+	static constexpr size_t DEFAULT_CAPACITY{ 1024 };
+
+	/**
+	 * @brief				Starts reading lines from the specified stream on a background thread.
+	 * @param is		  -	The input stream to read from. It must outlive the background thread, which only ends at the end of the stream.
+	 * @param capacity	  -	The maximum number of lines that may be waiting in the queue.
+	 */
+	LineReader(std::istream& is, size_t const capacity = DEFAULT_CAPACITY) : state{ std::make_shared<shared_state>(std::max<size_t>(capacity, 1)) }
+	{
+		std::thread([state = state, &is] {
+			for (std::string line; std::getline(is, line);) {
+				std::unique_lock lock{ state->mutex };
+				state->notFull.wait(lock, [&] { return state->lines.size() < state->capacity || state->abandoned; });
+				if (state->abandoned)
+					return;
+				state->lines.emplace_back(std::move(line));
+				const bool wasEmpty{ state->lines.size() == 1 };
+				lock.unlock();
+				if (wasEmpty) // the consumer can only be waiting when the queue was empty
+					state->notEmpty.notify_one();
+			}
+			{
+				std::scoped_lock lock{ state->mutex };
+				state->eof = true;
+			}
+			state->notEmpty.notify_one();
+		}).detach();
+	}
+	~LineReader()
+	{
+		{
+			std::scoped_lock lock{ state->mutex };
+			state->abandoned = true;
+		}
+		state->notFull.notify_one();
+	}
+
+	/**
+	 * @brief			Takes the next line from the queue, waiting for one to arrive if it is empty.
+	 * @param line	  -	Receives the next line.
+	 * @returns			true when a line was taken; false when the end of the stream was reached and every line has been taken.
+	 */
+	bool pop(std::string& line)
+	{
+		std::unique_lock lock{ state->mutex };
+		state->notEmpty.wait(lock, [this] { return !state->lines.empty() || state->eof; });
+		if (state->lines.empty())
+			return false;
+		take(lock, line);
+		return true;
+	}
+	/**
+	 * @brief			Takes the next line from the queue if one is waiting.
+	 * @param line	  -	Receives the next line.
+	 * @returns			true when a line was taken; otherwise false.
+	 */
+	bool try_pop(std::string& line)
+	{
+		std::unique_lock lock{ state->mutex };
+		if (state->lines.empty())
+			return false;
+		take(lock, line);
+		return true;
+	}
+	/// @brief	Checks whether the end of the stream was reached and every line has been taken.
+	bool done() const
+	{
+		std::scoped_lock lock{ state->mutex };
+		return state->eof && state->lines.empty();
+	}
+};
@@ -0,0 +1,164 @@
+#pragma once
+// ARRCON
+#include "../net/stats.hpp"	//< for net::rcon::response_info
+
+// STL
+#include <array>		//< for std::array
+#include <chrono>		//< for std::chrono
+#include <ostream>		//< for std::ostream
+#include <string_view>	//< for std::string_view
+
+/**
+ * @brief			Writes text to an output stream as the contents of a JSON string, escaping it in a single pass.
+ *\n				Runs of characters that don't need to be escaped are written directly from the input.
+ * @param os	  -	The output stream to write to.
+ * @param text	  -	The text to write. Bytes above 0x7F are written as-is, so UTF-8 text remains UTF-8.
+ */
+inline void write_json_escaped(std::ostream& os, std::string_view text)
+{
+	// the escape sequence of each character that needs one, or 0 for characters that are written as-is
+	static constexpr std::array<char, 128> ESCAPES{ [] {
+		std::array<char, 128> escapes{};
+		for (size_t i{ 0 }; i < 0x20; ++i) {
+			escapes[i] = 'u';
+		}
+		escapes['\b'] = 'b';
+		escapes['\f'] = 'f';
+		escapes['\n'] = 'n';
+		escapes['\r'] = 'r';
+		escapes['\t'] = 't';
+		escapes['"'] = '"';
+		escapes['\\'] = '\\';
+		return escapes;
+	}() };
+	static constexpr std::string_view HEX_DIGITS{ "0123456789abcdef" };
+
+	size_t runStart{ 0 };
+	for (size_t i{ 0 }; i < text.size(); ++i) {
+		const auto ch{ static_cast<unsigned char>(text[i]) };
+		if (ch >= ESCAPES.size() || ESCAPES[ch] == 0)
+			continue;
+
+		os.write(text.data() + runStart, static_cast<std::streamsize>(i - runStart));
+		runStart = i + 1;
+
+		if (const char escape{ ESCAPES[ch] }; escape == 'u') {
+			const char sequence[]{ '\\', 'u', '0', '0', HEX_DIGITS[ch >> 4], HEX_DIGITS[ch & 0xF] };
+			os.write(sequence, sizeof(sequence));
+		}
+		else {
+			const char sequence[]{ '\\', escape };
+			os.write(sequence, sizeof(sequence));
+		}
+	}
+	os.write(text.data() + runStart, static_cast<std::streamsize>(text.size() - runStart));
+}
+
+/**
+ * @class	NdjsonWriter
+ * @brief	Writes the result of each command to an output stream as a single-line JSON object (newline-delimited JSON).
+ *\n		Each record is written as soon as it is complete; the response body is escaped & written as it is received.
+ *\n		Fields: "target", "command", "response", "bytes", then "packets", "first_byte_us" & "last_byte_us" when they are known,
+ *			 or "error" instead of the response fields when the command couldn't be sent.
+ */
+class NdjsonWriter {
+	std::ostream& os;
+	/// @brief	The number of response bytes written to the current record.
+	size_t bytes{ 0 };
+
+	void write_string_field(std::string_view name, std::string_view value)
+	{
+		os << '"' << name << "\":\"";
+		write_json_escaped(os, value);
+		os << '"';
+	}
+
+public:
+	NdjsonWriter(std::ostream& os) : os{ os } {}
+
+	/**
+	 * @brief			Starts a record.
+	 * @param target  -	The name or address of the target that the command was sent to.
+	 * @param command -	The command.
+	 */
+	void begin(std::string_view target, std::string_view command)
+	{
+		bytes = 0;
+		os << '{';
+		write_string_field("target", target);
+		os << ',';
+		write_string_field("command", command);
+		os << ",\"response\":\"";
+	}
+	/**
+	 * @brief			Writes the next chunk of the response to the current record.
+	 * @param chunk	  -	The next chunk of the response.
+	 */
+	void write(std::string_view chunk)
+	{
+		write_json_escaped(os, chunk);
+		bytes += chunk.size();
+	}
+	/**
+	 * @brief			Finishes the current record, then flushes the output stream.
+	 * @param info	  -	Details about how the response was received, or nullptr if they aren't known.
+	 */
+	void end(net::rcon::response_info const* info)
+	{
+		const auto us{ [](std::chrono::steady_clock::duration const duration) { return std::chrono::duration_cast<std::chrono::microseconds>(duration).count(); } };
+
+		os << "\",\"bytes\":" << bytes;
+		if (info != nullptr) {
+			os << ",\"packets\":" << info->packets
+				<< ",\"first_byte_us\":" << us(info->firstByte)
+				<< ",\"last_byte_us\":" << us(info->lastByte);
+		}
+		os << "}\n";
+		os.flush();
+	}
+
+	/**
+	 * @brief			Finishes the current record with an error message instead of response details, then flushes the output stream.
+	 * @param message -	The error message.
+	 */
+	void fail(std::string_view message)
+	{
+		os << "\",\"bytes\":" << bytes << ',';
+		write_string_field("error", message);
+		os << "}\n";
+		os.flush();
+	}
+
+	/**
+	 * @brief			Writes a complete record.
+	 * @param target  -	The name or address of the target that the command was sent to.
+	 * @param command -	The command.
+	 * @param response-	The complete response.
+	 * @param info	  -	Details about how the response was received, or nullptr if they aren't known.
+	 */
+	void record(std::string_view target, std::string_view command, std::string_view response, net::rcon::response_info const* info)
+	{
+		begin(target, command);
+		write(response);
+		end(info);
+	}
+	/**
+	 * @brief			Writes a record for a command that failed.
+	 * @param target  -	The name or address of the target that the command was meant for.
+	 * @param command -	The command, or an empty string if the failure doesn't belong to a specific command.
+	 * @param message -	The error message.
+	 */
+	void error(std::string_view target, std::string_view command, std::string_view message)
+	{
+		os << '{';
+		write_string_field("target", target);
+		if (!command.empty()) {
+			os << ',';
+			write_string_field("command", command);
+		}
+		os << ',';
+		write_string_field("error", message);
+		os << "}\n";
+		os.flush();
+	}
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include "../ExceptionBuilder.hpp"
+
+// Boost::interprocess
+#include <boost/interprocess/file_mapping.hpp>		//< for boost::interprocess::file_mapping
+#include <boost/interprocess/mapped_region.hpp>		//< for boost::interprocess::mapped_region
+
+// STL
+#include <cstring>		//< for std::memchr
+#include <filesystem>	//< for std::filesystem
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
+#include <vector>		//< for std::vector
+
+/**
+ * @class	ScriptFile
+ * @brief	Reads commands from a script file, which is memory-mapped rather than read into memory.
+ *\n		Each line is a command, except for blank lines & comment lines (starting with ';' or '#'), which are skipped.
+ *			 Leading whitespace, trailing carriage returns, and a leading UTF-8 byte order mark are ignored.
+ *\n		Commands are views into the mapped file, so they remain valid for the lifetime of the ScriptFile.
+ */
+class ScriptFile {
+	static constexpr std::string_view WHITESPACE{ " \t\v\f" };
+	static constexpr std::string_view UTF8_BOM{ "\xEF\xBB\xBF" };
+
+	boost::interprocess::file_mapping mapping;
+	boost::interprocess::mapped_region region;
+	std::string_view text;
+	size_t pos{ 0 };
+
+public:
+	/**
+	 * @brief			Maps the specified script file into memory.
+	 * @param path	  -	The path to the script file.
+	 */
+	ScriptFile(std::filesystem::path const& path) noexcept(false)
+	{
+		std::error_code ec;
+		if (!std::filesystem::is_regular_file(path, ec))
+			throw make_exception("The specified script file ", path, " doesn't exist!");
+
+		// empty files can't be mapped
+		if (std::filesystem::file_size(path, ec) == 0 || ec)
+			return;
+
+		try {
+			mapping = boost::interprocess::file_mapping(path.string().c_str(), boost::interprocess::read_only);
+			region = boost::interprocess::mapped_region(mapping, boost::interprocess::read_only);
+			region.advise(boost::interprocess::mapped_region::advice_sequential);
+		} catch (std::exception const& ex) {
+			throw make_exception("Failed to open script file ", path, " due to error: ", ex.what());
+		}
+
+		text = { static_cast<const char*>(region.get_address()), region.get_size() };
+		if (text.starts_with(UTF8_BOM))
+			pos = UTF8_BOM.size();
+	}
+
+	/**
+	 * @brief			Gets the next command from the script file.
+	 * @param command -	Receives a view of the next command.
+	 * @returns			true when a command was found; false when the end of the file was reached.
+	 */
+	bool next(std::string_view& command) noexcept
+	{
+		while (pos < text.size()) {
+			const auto* const lineEnd{ static_cast<const char*>(std::memchr(text.data() + pos, '\n', text.size() - pos)) };
+			const size_t end{ lineEnd == nullptr ? text.size() : static_cast<size_t>(lineEnd - text.data()) };
+
+			std::string_view line{ text.substr(pos, end - pos) };
+			pos = end + 1;
+
+			if (line.ends_with('\r'))
+				line.remove_suffix(1);
+			if (const auto first{ line.find_first_not_of(WHITESPACE) }; first == std::string_view::npos)
+				continue; //< blank line
+			else line.remove_prefix(first);
+			if (line.front() == ';' || line.front() == '#')
+				continue; //< comment line
+
+			command = line;
+			return true;
+		}
+		return false;
+	}
+
+	/// @brief	Gets all of the remaining commands in the script file as a vector.
+	std::vector<std::string> read_all()
+	{
+		std::vector<std::string> commands;
+		for (std::string_view command; next(command);) {
+			commands.emplace_back(command);
+		}
+		return commands;
+	}
+};
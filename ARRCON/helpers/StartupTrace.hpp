@@ -0,0 +1,82 @@
+#pragma once
+// STL
+#include <array>		//< for std::array
+#include <chrono>		//< for std::chrono
+#include <iomanip>		//< for std::setw, std::setprecision
+#include <ostream>		//< for std::ostream
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
+
+/**
+ * @class	StartupTrace
+ * @brief	Records how long each phase of startup takes, and prints a report of them when enabled by "--trace-startup".
+ *\n		Phases are always recorded, since the option can't be checked until the arguments have been parsed.
+ *			 Recording a phase doesn't allocate; phases beyond the capacity are added to the last one.
+ */
+class StartupTrace {
+	using clock = std::chrono::steady_clock;
+
+	static constexpr size_t CAPACITY{ 16 };
+
+	struct phase {
+		std::string_view name;
+		clock::duration duration;
+	};
+
+	std::ostream& os;
+	const clock::time_point start;
+	clock::time_point last;
+	std::array<phase, CAPACITY> phases{};
+	size_t count{ 0 };
+	bool enabled{ false };
+	bool reported{ false };
+
+public:
+	/**
+	 * @brief			Starts timing the first phase.
+	 * @param os	  -	The output stream to print the report to.
+	 */
+	StartupTrace(std::ostream& os) : os{ os }, start{ clock::now() }, last{ start } {}
+	/// @brief	Prints the report, unless it was already printed.
+	~StartupTrace() { report(); }
+
+	/// @brief	Sets whether the report is printed.
+	void enable(bool const state) noexcept { enabled = state; }
+
+	/**
+	 * @brief			Ends the current phase, and starts timing the next one.
+	 * @param name	  -	The name of the phase that just ended. Must be a string literal.
+	 */
+	void mark(std::string_view const name) noexcept
+	{
+		const auto now{ clock::now() };
+		if (count < CAPACITY)
+			phases[count++] = { name, now - last };
+		else phases[CAPACITY - 1].duration += now - last;
+		last = now;
+	}
+
+	/// @brief	Prints the duration of each recorded phase and the total, when enabled. Only the first call prints anything.
+	void report()
+	{
+		if (!enabled || reported)
+			return;
+		reported = true;
+
+		const auto ms{ [](clock::duration const duration) { return std::chrono::duration<double, std::milli>(duration).count(); } };
+
+		os << "Startup Trace" << '\n';
+		size_t longestName{ 5 };
+		for (size_t i{ 0 }; i < count; ++i) {
+			if (phases[i].name.size() > longestName)
+				longestName = phases[i].name.size();
+		}
+		const auto flags{ os.flags() };
+		os << std::fixed << std::setprecision(3);
+		for (size_t i{ 0 }; i < count; ++i) {
+			os << "  " << phases[i].name << std::string(longestName + 2 - phases[i].name.size(), ' ') << std::setw(9) << ms(phases[i].duration) << " ms\n";
+		}
+		os << "  total" << std::string(longestName + 2 - 5, ' ') << std::setw(9) << ms(last - start) << " ms" << std::endl;
+		os.flags(flags);
+	}
+};
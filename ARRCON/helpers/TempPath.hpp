@@ -0,0 +1,30 @@
+#pragma once
+// STL
+#include <filesystem>	//< for std::filesystem
+#include <random>		//< for std::random_device
+#include <string>		//< for std::to_string
+
+#ifdef _WIN32
+#include <process.h>	//< for _getpid
+#else
+#include <unistd.h>		//< for getpid
+#endif
+
+/**
+ * @brief			Gets a temporary path next to the specified file, which is unique to this process & call.
+ *\n				Files are written to a temporary path and then renamed over the original, so concurrent writers
+ *					 never write to the same temporary file and each rename replaces the file with a complete one.
+ * @param path	  -	The location of the file that will be replaced.
+ * @returns			The path with the process ID, a random suffix, and a ".tmp" extension appended to it.
+ */
+inline std::filesystem::path make_temp_path(std::filesystem::path const& path)
+{
+#ifdef _WIN32
+	const auto pid{ _getpid() };
+#else
+	const auto pid{ getpid() };
+#endif
+	auto tmpPath{ path };
+	tmpPath += '.' + std::to_string(pid) + '.' + std::to_string(std::random_device{}()) + ".tmp";
+	return tmpPath;
+}
@@ -0,0 +1,54 @@
+#pragma once
+// STL
+#include <ostream>		//< for std::ostream
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
+
+/**
+ * @class	TrimmedWriter
+ * @brief	Writes text to an output stream in chunks as it arrives, without leading or trailing whitespace.
+ *\n		The output is the same as trimming the full text before writing it, but only trailing
+ *			 whitespace is held back (until more text arrives) instead of the entire text.
+ */
+class TrimmedWriter {
+	static constexpr std::string_view WHITESPACE{ " \t\r\n\v\f" };
+
+	std::ostream& os;
+	/// @brief	Whitespace that will only be written if more non-whitespace text follows it.
+	std::string pendingWhitespace;
+	bool hasWritten{ false };
+
+public:
+	TrimmedWriter(std::ostream& os) : os{ os } {}
+
+	/**
+	 * @brief			Writes the next chunk of text to the output stream, then flushes it.
+	 * @param text	  -	The next chunk of text.
+	 */
+	void write(std::string_view text)
+	{
+		if (!hasWritten) {
+			// skip leading whitespace
+			if (const auto first{ text.find_first_not_of(WHITESPACE) }; first == std::string_view::npos)
+				return;
+			else text.remove_prefix(first);
+		}
+
+		const auto last{ text.find_last_not_of(WHITESPACE) };
+		if (last == std::string_view::npos) {
+			// this chunk is entirely whitespace
+			pendingWhitespace.append(text);
+			return;
+		}
+
+		os << pendingWhitespace;
+		os.write(text.data(), last + 1);
+		os.flush();
+
+		pendingWhitespace.assign(text.substr(last + 1));
+		hasWritten = true;
+	}
+
+	/// @brief	Checks whether nothing except whitespace has been written yet.
+	bool empty() const noexcept { return !hasWritten; }
+};
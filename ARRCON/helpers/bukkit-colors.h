@@ -9,107 +9,170 @@
 #include <color-values.h>	//< for color codes
 #include <setcolor.hpp>		//< for term::setcolor
 
-namespace mc_color {
-	inline bool color_code_to_sequence(char const ch, std::string& sequence)
-	{
-		switch (ch) {
-		case '0': // black
-			sequence = color::setcolor(color::black);
-			return true;
-		case '1': // dark blue
-			sequence = color::setcolor(color::dark_blue);
-			return true;
-		case '2': // dark green
-			sequence = color::setcolor(color::dark_green);
-			return true;
-		case '3': // dark aqua
-			sequence = color::setcolor(color::dark_cyan);
-			return true;
-		case '4': // dark red
-			sequence = color::setcolor(color::dark_red);
-			return true;
-		case '5': // dark purple
-			sequence = color::setcolor(color::dark_purple);
-			return true;
-		case '6': // gold
-			sequence = color::setcolor(color::gold);
-			return true;
-		case '7': // gray
-			sequence = color::setcolor(color::gray);
-			return true;
-		case '8': // dark gray
-			sequence = color::setcolor(color::dark_gray);
-			return true;
-		case '9': // blue
-			sequence = color::setcolor(color::blue);
-			return true;
-		case 'a': // green
-			sequence = color::setcolor(color::green);
-			return true;
-		case 'b': // aqua
-			sequence = color::setcolor(color::cyan);
-			return true;
-		case 'c': // red
-			sequence = color::setcolor(color::red);
-			return true;
-		case 'd': // light purple
-			sequence = color::setcolor(color::light_purple);
-			return true;
-		case 'e': // yellow
-			sequence = color::setcolor(color::yellow);
-			return true;
-		case 'f': // white
-			sequence = color::setcolor(color::white);
-			return true;
-		case 'r': // reset
-			sequence = color::reset;
-			return true;
-		case 'n': // underline
-			sequence = color::underline;
-			return true;
-		case 'l': // bold
-			sequence = color::bold;
-			return true;
-		case 'k': // obfuscated
-			return true;
-		case 'm': // strikethrough
-			return true;
-		case 'o': // italic
-			return true;
-		default:
-			return{};
-		}
-		return false;
-	}
+// STL
+#include <algorithm>	//< for std::min
+#include <array>		//< for std::array
+#include <cstring>		//< for std::memchr
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
 
+namespace mc_color {
 	// The ASCII section sign character(s)
 #define SECTION_SIGN "§"
 
+	/// @brief	The UTF-8 encoding of the section sign that starts each color code.
+	inline constexpr const std::string_view SECTION_SIGN_UTF8{ "\xC2\xA7" };
+
+	/// @brief	The kinds of bukkit formatting codes.
+	enum class CodeKind : uint8_t {
+		/// @brief	Not a formatting code; it is left as-is.
+		None,
+		/// @brief	A foreground color.
+		Color,
+		/// @brief	Resets all formatting.
+		Reset,
+		Underline,
+		Bold,
+		/// @brief	A formatting code that is removed, since it has no ANSI equivalent. (obfuscated, strikethrough, italic)
+		Removed,
+	};
+
+	/// @brief	Maps the character after a section sign to its kind of formatting code.
+	inline constexpr const std::array<CodeKind, 256> CODE_KINDS{ [] {
+		std::array<CodeKind, 256> kinds{};
+		for (const char ch : std::string_view{ "0123456789abcdef" }) {
+			kinds[static_cast<unsigned char>(ch)] = CodeKind::Color;
+		}
+		kinds['r'] = CodeKind::Reset;
+		kinds['n'] = CodeKind::Underline;
+		kinds['l'] = CodeKind::Bold;
+		kinds['k'] = CodeKind::Removed;
+		kinds['m'] = CodeKind::Removed;
+		kinds['o'] = CodeKind::Removed;
+		return kinds;
+	}() };
+
 	/**
-	 * @brief			Replaces Minecraft Bukkit color codes in the specified
-	 *					 message with the corresponding ANSI escape sequence.
-	 * @param message -	The string to replace the bukkit color codes in.
-	 * @returns			The converted message string.
+	 * @brief			Gets the ANSI escape sequence that the specified bukkit formatting code is replaced with.
+	 *\n				The sequences are generated once, on the first call.
+	 * @param ch	  -	The character after the section sign.
+	 * @returns			The replacement sequence, which is empty when the code is removed or isn't a formatting code.
 	 */
-	inline std::string replace_color_codes(std::string message)
+	inline std::string_view get_sequence(char const ch)
 	{
-		for (size_t pos{ message.rfind(SECTION_SIGN) }, lastPos{ std::string::npos };
-			 pos != std::string::npos;
-			 lastPos = pos, pos = message.rfind(SECTION_SIGN, pos - 1)) {
-			// We need to check the last pos to prevent previous blank
-			//  replacement sequences from interfering with this one.
-			// For example, "§§oo" should output "§o", not ""
-			if (pos + 2 >= message.size() || pos + 2 == lastPos)
-				continue;
+		static const std::array<std::string, 256> sequences{ [] {
+			std::array<std::string, 256> seq;
+			seq['0'] = color::setcolor(color::black);
+			seq['1'] = color::setcolor(color::dark_blue);
+			seq['2'] = color::setcolor(color::dark_green);
+			seq['3'] = color::setcolor(color::dark_cyan);		//< dark aqua
+			seq['4'] = color::setcolor(color::dark_red);
+			seq['5'] = color::setcolor(color::dark_purple);
+			seq['6'] = color::setcolor(color::gold);
+			seq['7'] = color::setcolor(color::gray);
+			seq['8'] = color::setcolor(color::dark_gray);
+			seq['9'] = color::setcolor(color::blue);
+			seq['a'] = color::setcolor(color::green);
+			seq['b'] = color::setcolor(color::cyan);			//< aqua
+			seq['c'] = color::setcolor(color::red);
+			seq['d'] = color::setcolor(color::light_purple);
+			seq['e'] = color::setcolor(color::yellow);
+			seq['f'] = color::setcolor(color::white);
+			seq['r'] = color::reset;
+			seq['n'] = color::underline;
+			seq['l'] = color::bold;
+			return seq;
+		}() };
+		return sequences[static_cast<unsigned char>(ch)];
+	}
+
+	/**
+	 * @class	color_code_translator
+	 * @brief	Replaces Minecraft Bukkit color codes with the corresponding ANSI escape sequences in text that arrives in chunks,
+	 *			 such as the packets of a response. Codes that are split between chunks are translated as if they weren't.
+	 */
+	class color_code_translator {
+		/// @brief	The incomplete color code at the end of the previous chunk, if any.
+		std::string pending;
+
+		/// @brief	Translates text that doesn't start with an incomplete code, holding back any incomplete code at the end of it.
+		void translate_complete(std::string_view text, std::string& out)
+		{
+			const char* const end{ text.data() + text.size() };
+			const char* pos{ text.data() };
+			while (pos != end) {
+				const auto* lead{ static_cast<const char*>(std::memchr(pos, SECTION_SIGN_UTF8[0], static_cast<size_t>(end - pos))) };
+				if (lead == nullptr) {
+					out.append(pos, end);
+					return;
+				}
+				out.append(pos, lead);
+
+				const auto remaining{ static_cast<size_t>(end - lead) };
+				if (remaining < 3) {
+					if (std::string_view{ lead, remaining } == SECTION_SIGN_UTF8.substr(0, remaining)) {
+						// the code continues in the next chunk
+						pending.assign(lead, remaining);
+						return;
+					}
+				}
+				else if (lead[1] == SECTION_SIGN_UTF8[1] && CODE_KINDS[static_cast<unsigned char>(lead[2])] != CodeKind::None) {
+					out.append(get_sequence(lead[2]));
+					pos = lead + 3;
+					continue;
+				}
 
-			const auto it{ message.begin() + pos };
+				// not a color code
+				out.push_back(*lead);
+				pos = lead + 1;
+			}
+		}
 
-			if (std::string colorSequence;
-				color_code_to_sequence(*(it + 2), colorSequence)) {
-				message.replace(it, it + 3, colorSequence);
+	public:
+		/**
+		 * @brief			Translates the next chunk of text.
+		 * @param chunk	  -	The next chunk of text.
+		 * @param out	  -	The string to append the translated text to.
+		 */
+		void translate(std::string_view chunk, std::string& out)
+		{
+			// complete the code that was split from the previous chunk; at most 2 more characters are needed,
+			//  and any code that starts within them is held back again if it is also incomplete
+			while (!pending.empty() && !chunk.empty()) {
+				const auto taken{ std::min<size_t>(chunk.size(), SECTION_SIGN_UTF8.size()) };
+				std::string head{ std::move(pending) };
+				pending.clear();
+				head.append(chunk.substr(0, taken));
+				chunk.remove_prefix(taken);
+				translate_complete(head, out);
 			}
+			translate_complete(chunk, out);
+		}
+
+		/**
+		 * @brief			Writes any incomplete color code that was held back from the last chunk, since no more text will follow it.
+		 * @param out	  -	The string to append the remaining text to.
+		 */
+		void finish(std::string& out)
+		{
+			out.append(pending);
+			pending.clear();
 		}
+	};
 
-		return message;
+	/**
+	 * @brief			Replaces Minecraft Bukkit color codes in the specified
+	 *					 message with the corresponding ANSI escape sequence.
+	 * @param message -	The string to replace the bukkit color codes in.
+	 * @returns			The converted message string.
+	 */
+	inline std::string replace_color_codes(std::string_view message)
+	{
+		std::string out;
+		out.reserve(message.size());
+		color_code_translator translator;
+		translator.translate(message, out);
+		translator.finish(out);
+		return out;
 	}
 }
@@ -0,0 +1,377 @@
+#pragma once
+#include "logging.hpp"
+#include "config.hpp"
+#include "helpers/TempPath.hpp"
+
+// Boost::interprocess
+#include <boost/interprocess/file_mapping.hpp>		//< for boost::interprocess::file_mapping
+#include <boost/interprocess/mapped_region.hpp>		//< for boost::interprocess::mapped_region
+
+// STL
+#include <array>		//< for std::array
+#include <cstdint>		//< for sized integer types
+#include <cstring>		//< for std::memcpy
+#include <filesystem>	//< for std::filesystem
+#include <fstream>		//< for std::ofstream
+#include <iterator>		//< for std::forward_iterator_tag
+#include <optional>		//< for std::optional
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
+#include <type_traits>	//< for std::is_trivially_copyable_v
+#include <utility>		//< for std::pair
+
+#ifndef _WIN32
+#include <sys/stat.h>	//< for umask
+#endif
+
+namespace config {
+	/**
+	 * @class	HostsIndex
+	 * @brief	Compact, memory-mapped index of the hosts file, which allows saved hosts to be looked up without parsing the hosts file.
+	 *\n		The index is stored next to the hosts file with an ".idx" extension, and records the modification time & size of the
+	 *			 hosts file that it was built from. When they no longer match, the index is rebuilt from the hosts file automatically.
+	 *\n		Layout: a header, an open-addressing hash table of (name hash, record offset) buckets, then the records in name order.
+	 *			 Each record holds the name, host, port & password as length-prefixed strings, followed by the response end strategy & dialect.
+	 */
+	class HostsIndex {
+		using target_info = net::rcon::target_info;
+
+		static constexpr std::array<char, 8> MAGIC{ 'A', 'R', 'R', 'C', 'O', 'N', 'H', 'I' };
+		/// @brief	Incremented whenever the layout changes, so that indexes written by other versions are rebuilt.
+		static constexpr uint32_t VERSION{ 2 };
+
+		struct header {
+			std::array<char, 8> magic;
+			uint32_t version;
+			/// @brief	The number of records.
+			uint32_t count;
+			/// @brief	The number of buckets in the hash table; always a power of two.
+			uint32_t bucketCount;
+			uint32_t reserved;
+			/// @brief	The modification time of the hosts file that the index was built from.
+			int64_t sourceTime;
+			/// @brief	The size of the hosts file that the index was built from.
+			uint64_t sourceSize;
+		};
+		struct bucket {
+			uint32_t hash;
+			/// @brief	The offset of the record from the start of the index, or 0 when the bucket is empty.
+			uint32_t offset;
+		};
+		static_assert(std::is_trivially_copyable_v<header> && std::is_trivially_copyable_v<bucket>);
+
+		/// @brief	The size of a record's fixed-size fields; the response end mode, idle gap & dialect.
+		static constexpr size_t RECORD_TRAILER_SIZE{ sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t) };
+
+		std::filesystem::path path;
+		boost::interprocess::file_mapping mapping;
+		boost::interprocess::mapped_region region;
+		/// @brief	The index, when it was rebuilt rather than mapped.
+		std::string owned;
+		std::string_view data;
+		header head{};
+
+		/// @brief	32-bit FNV-1a hash of a host name.
+		static constexpr uint32_t hash_name(std::string_view const name) noexcept
+		{
+			uint32_t hash{ 2166136261u };
+			for (const char ch : name) {
+				hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619u;
+			}
+			return hash;
+		}
+
+		/// @brief	Gets the modification time & size of the hosts file, which the index must match to be used.
+		static std::pair<int64_t, uint64_t> get_source_fingerprint(std::filesystem::path const& hostsPath) noexcept(false)
+		{
+			return{
+				static_cast<int64_t>(std::filesystem::last_write_time(hostsPath).time_since_epoch().count()),
+				static_cast<uint64_t>(std::filesystem::file_size(hostsPath))
+			};
+		}
+
+		template<typename T>
+		static void append(std::string& out, T const value)
+		{
+			out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+		static void append_string(std::string& out, std::string_view const s)
+		{
+			append(out, static_cast<uint32_t>(s.size()));
+			out.append(s);
+		}
+
+		/// @brief	Builds an index of the specified hosts.
+		static std::string serialize(SavedHosts const& hosts, std::pair<int64_t, uint64_t> const& source)
+		{
+			uint32_t bucketCount{ 8 };
+			while (bucketCount < hosts.size() * 2) {
+				bucketCount <<= 1;
+			}
+
+			const header h{ MAGIC, VERSION, static_cast<uint32_t>(hosts.size()), bucketCount, 0, source.first, source.second };
+			std::string out;
+			append(out, h);
+			out.append(bucketCount * sizeof(bucket), '\0');
+
+			for (const auto& [name, info] : hosts) {
+				const auto offset{ static_cast<uint32_t>(out.size()) };
+				append_string(out, name);
+				append_string(out, info.host);
+				append_string(out, info.port);
+				append_string(out, info.pass);
+				append(out, static_cast<uint8_t>(info.responseEnd.mode));
+				append(out, static_cast<uint32_t>(info.responseEnd.idleGap.count()));
+				append(out, static_cast<uint8_t>(info.dialect));
+
+				const auto hash{ hash_name(name) };
+				for (uint32_t i{ hash & (bucketCount - 1) };; i = (i + 1) & (bucketCount - 1)) {
+					char* const b{ out.data() + sizeof(header) + i * sizeof(bucket) };
+					bucket existing;
+					std::memcpy(&existing, b, sizeof(bucket));
+					if (existing.offset == 0) {
+						const bucket entry{ hash, offset };
+						std::memcpy(b, &entry, sizeof(bucket));
+						break;
+					}
+				}
+			}
+			return out;
+		}
+
+		/// @brief	Writes the index to the specified path, replacing it atomically.
+		static void save(std::filesystem::path const& path, std::string_view const index)
+		{
+			const auto tmpPath{ make_temp_path(path) };
+			{
+				// the index contains the saved passwords, so only the current user may read it; the file is created with these permissions, so it's never readable by others
+#ifndef _WIN32
+				const auto previousMask{ ::umask(0077) };
+#endif
+				std::ofstream ofs{ tmpPath, std::ios::binary | std::ios::trunc };
+#ifndef _WIN32
+				::umask(previousMask);
+#endif
+				if (!ofs || !ofs.write(index.data(), static_cast<std::streamsize>(index.size()))) {
+					ARRCON_LOG(LogLevel::Warning) << "Failed to write the hosts index to " << tmpPath << std::endl;
+					return;
+				}
+			}
+
+			std::error_code ec;
+			std::filesystem::rename(tmpPath, path, ec);
+			if (ec) {
+				ARRCON_LOG(LogLevel::Warning) << "Failed to save the hosts index to " << path << " due to error: " << ec.message() << std::endl;
+				std::filesystem::remove(tmpPath, ec);
+			}
+		}
+
+		/// @brief	Reads and validates the header of the index, then sets it as the current index.
+		bool use(std::string_view const index, std::pair<int64_t, uint64_t> const& source) noexcept
+		{
+			if (index.size() < sizeof(header))
+				return false;
+
+			header h;
+			std::memcpy(&h, index.data(), sizeof(header));
+			if (h.magic != MAGIC || h.version != VERSION
+				|| h.sourceTime != source.first || h.sourceSize != source.second
+				|| h.bucketCount == 0 || (h.bucketCount & (h.bucketCount - 1)) != 0
+				|| index.size() < sizeof(header) + static_cast<size_t>(h.bucketCount) * sizeof(bucket))
+				return false;
+
+			head = h;
+			data = index;
+			return true;
+		}
+
+		/// @brief	Maps the index file, and uses it when it is up-to-date.
+		bool open(std::pair<int64_t, uint64_t> const& source) noexcept
+		{
+			std::error_code ec;
+			if (!std::filesystem::is_regular_file(path, ec) || std::filesystem::file_size(path, ec) < sizeof(header) || ec)
+				return false;
+#ifndef _WIN32
+			// rebuild indexes that other users can read, which older versions created
+			if (const auto perms{ std::filesystem::status(path, ec).permissions() }; ec || (perms & (std::filesystem::perms::group_all | std::filesystem::perms::others_all)) != std::filesystem::perms::none)
+				return false;
+#endif
+
+			try {
+				mapping = boost::interprocess::file_mapping(path.string().c_str(), boost::interprocess::read_only);
+				region = boost::interprocess::mapped_region(mapping, boost::interprocess::read_only);
+			} catch (std::exception const& ex) {
+				ARRCON_LOG(LogLevel::Warning) << "Failed to open the hosts index " << path << " due to error: " << ex.what() << std::endl;
+				return false;
+			}
+
+			return use({ static_cast<const char*>(region.get_address()), region.get_size() }, source);
+		}
+
+		/// @brief	Gets the offset of the first record, which follows the hash table.
+		size_t records_begin() const noexcept
+		{
+			return sizeof(header) + static_cast<size_t>(head.bucketCount) * sizeof(bucket);
+		}
+
+		/**
+		 * @brief			Decodes the record at the specified offset.
+		 * @param offset  -	The offset of the record from the start of the index.
+		 * @param next	  -	Receives the offset of the following record.
+		 * @returns			The name of the saved host and its target info.
+		 */
+		std::pair<std::string_view, target_info> decode(size_t offset, size_t& next) const noexcept(false)
+		{
+			const auto read_string{ [&]() -> std::string_view {
+				uint32_t length;
+				if (data.size() < offset + sizeof(length))
+					throw make_exception("The hosts index ", path, " is corrupted; delete it to rebuild it from the hosts file!");
+				std::memcpy(&length, data.data() + offset, sizeof(length));
+				offset += sizeof(length);
+				if (data.size() - offset < length)
+					throw make_exception("The hosts index ", path, " is corrupted; delete it to rebuild it from the hosts file!");
+				const auto s{ data.substr(offset, length) };
+				offset += length;
+				return s;
+			} };
+
+			std::pair<std::string_view, target_info> entry;
+			entry.first = read_string();
+			entry.second.host = read_string();
+			entry.second.port = read_string();
+			entry.second.pass = read_string();
+
+			if (data.size() - offset < RECORD_TRAILER_SIZE)
+				throw make_exception("The hosts index ", path, " is corrupted; delete it to rebuild it from the hosts file!");
+			uint8_t mode;
+			uint32_t idleGap;
+			uint8_t dialect;
+			std::memcpy(&mode, data.data() + offset, sizeof(mode));
+			std::memcpy(&idleGap, data.data() + offset + sizeof(mode), sizeof(idleGap));
+			std::memcpy(&dialect, data.data() + offset + sizeof(mode) + sizeof(idleGap), sizeof(dialect));
+			entry.second.responseEnd.mode = static_cast<net::rcon::ResponseEnd>(mode);
+			entry.second.responseEnd.idleGap = std::chrono::milliseconds{ idleGap };
+			entry.second.dialect = static_cast<net::rcon::Dialect>(dialect);
+
+			next = offset + RECORD_TRAILER_SIZE;
+			return entry;
+		}
+
+	public:
+		/**
+		 * @brief				Opens the index of the specified hosts file, or rebuilds it when it is missing or out-of-date.
+		 * @param hostsPath	  -	The location of the hosts file, which must exist.
+		 */
+		HostsIndex(std::filesystem::path const& hostsPath) noexcept(false) : path{ get_path(hostsPath) }
+		{
+			// get the fingerprint before parsing, so that changes made while parsing cause the next run to rebuild the index
+			const auto source{ get_source_fingerprint(hostsPath) };
+			if (open(source)) {
+				ARRCON_LOG(LogLevel::Trace) << "Opened the hosts index " << path << " with " << head.count << " entr" << (head.count == 1 ? "y" : "ies") << '.' << std::endl;
+				return;
+			}
+
+			ARRCON_LOG(LogLevel::Debug) << "Rebuilding the hosts index " << path << std::endl;
+			// unmap the out-of-date index first, since it can't be replaced while it's open on Windows
+			region = {};
+			mapping = {};
+			owned = serialize(SavedHosts(hostsPath), source);
+			use(owned, source);
+			save(path, owned);
+		}
+		HostsIndex(HostsIndex const&) = delete;
+		HostsIndex& operator=(HostsIndex const&) = delete;
+
+		/// @brief	Gets the location of the index of the specified hosts file.
+		static std::filesystem::path get_path(std::filesystem::path const& hostsPath)
+		{
+			auto path{ hostsPath };
+			path += ".idx";
+			return path;
+		}
+
+		/**
+		 * @brief				Rebuilds the index of the specified hosts file from hosts that are already loaded. Use after writing the hosts file.
+		 * @param hostsPath	  -	The location of the hosts file.
+		 * @param hosts		  -	The hosts that were written to the hosts file.
+		 */
+		static void update(std::filesystem::path const& hostsPath, SavedHosts const& hosts)
+		{
+			std::error_code ec;
+			if (!std::filesystem::exists(hostsPath, ec))
+				return;
+			save(get_path(hostsPath), serialize(hosts, get_source_fingerprint(hostsPath)));
+		}
+
+		bool empty() const noexcept { return head.count == 0; }
+		size_t size() const noexcept { return head.count; }
+
+		/**
+		 * @brief			Gets the target info of the specified saved host.
+		 * @param name	  -	The name of the saved host.
+		 * @returns			The target info when the host exists; otherwise, std::nullopt.
+		 */
+		std::optional<target_info> get_host(std::string_view const name) const noexcept(false)
+		{
+			const auto hash{ hash_name(name) };
+			const uint32_t mask{ head.bucketCount - 1 };
+			for (uint32_t i{ hash & mask }, probes{ 0 }; probes < head.bucketCount; i = (i + 1) & mask, ++probes) {
+				bucket b;
+				std::memcpy(&b, data.data() + sizeof(header) + i * sizeof(bucket), sizeof(bucket));
+				if (b.offset == 0)
+					break;
+				if (b.hash != hash)
+					continue;
+
+				size_t next;
+				if (auto [entryName, info] { decode(b.offset, next) }; entryName == name)
+					return std::move(info);
+			}
+			return std::nullopt;
+		}
+		/// @brief	Checks whether the specified saved host exists.
+		bool contains(std::string_view const name) const noexcept(false)
+		{
+			return get_host(name).has_value();
+		}
+
+		/// @brief	Iterates through the saved hosts in name order, decoding each one as it is reached.
+		class const_iterator {
+			HostsIndex const* index{ nullptr };
+			size_t offset{ 0 };
+			size_t remaining{ 0 };
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair<std::string_view, target_info>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = value_type;
+
+			const_iterator() = default;
+			const_iterator(HostsIndex const* index, size_t offset, size_t remaining) : index{ index }, offset{ offset }, remaining{ remaining } {}
+
+			value_type operator*() const
+			{
+				size_t next;
+				return index->decode(offset, next);
+			}
+			const_iterator& operator++()
+			{
+				index->decode(offset, offset);
+				--remaining;
+				return *this;
+			}
+			const_iterator operator++(int)
+			{
+				auto copy{ *this };
+				++*this;
+				return copy;
+			}
+			friend bool operator==(const_iterator const& a, const_iterator const& b) noexcept { return a.remaining == b.remaining; }
+		};
+
+		const_iterator begin() const { return{ this, records_begin(), head.count }; }
+		const_iterator end() const { return{ this, 0, 0 }; }
+	};
+}
@@ -7,8 +7,21 @@
 #include <boost/date_time/posix_time/posix_time.hpp> //< for boost::posix_time
 
 // STL
+#include <array>		//< for std::array
+#include <atomic>		//< for std::atomic
+#include <cctype>		//< for std::toupper
 #include <cstdint>		//< for sized integer types
+#include <ctime>		//< for std::time
+#include <filesystem>	//< for std::filesystem::path
+#include <fstream>		//< for std::filebuf
+#include <functional>	//< for std::function
+#include <iostream>		//< for std::clog
+#include <mutex>		//< for std::once_flag, std::call_once
 #include <ostream>		//< for std::ostream
+#include <streambuf>	//< for std::streambuf
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
+#include <thread>		//< for std::thread
 
 // the margin size for the timestamp
 #define LM_TIMESTAMP 17
@@ -26,43 +39,91 @@ enum class LogLevel : uint8_t {
 	Fatal = 64,
 };
 
-inline std::ostream& operator<<(std::ostream& os, const LogLevel& logLevel)
+/// @brief	The lowest log level that is compiled in; messages below it are removed entirely. Set with -DARRCON_MIN_LOG_LEVEL=LogLevel::<Level>
+#ifndef ARRCON_MIN_LOG_LEVEL
+#define ARRCON_MIN_LOG_LEVEL LogLevel::Trace
+#endif
+inline constexpr const LogLevel MIN_LOG_LEVEL{ ARRCON_MIN_LOG_LEVEL };
+
+/// @brief	The lowest log level that is written to the log. Every message is written by default; the --log-level option raises it.
+inline std::atomic<LogLevel> log_level{ LogLevel::Trace };
+
+/// @brief	Checks if messages of the specified level are written to the log.
+inline bool is_log_enabled(LogLevel const level) noexcept
+{
+	return level >= MIN_LOG_LEVEL && level >= log_level.load(std::memory_order_relaxed);
+}
+
+/// @brief	Gets the name of the specified log level, or an empty string when it is invalid.
+constexpr std::string_view get_name(LogLevel const logLevel) noexcept
 {
 	switch (logLevel) {
 	case LogLevel::Trace:
-		os << "TRACE";
-		break;
+		return "TRACE";
 	case LogLevel::Debug:
-		os << "DEBUG";
-		break;
+		return "DEBUG";
 	case LogLevel::Info:
-		os << "INFO";
-		break;
+		return "INFO";
 	case LogLevel::Warning:
-		os << "WARN";
-		break;
+		return "WARN";
 	case LogLevel::Error:
-		os << "ERROR";
-		break;
+		return "ERROR";
 	case LogLevel::Critical:
-		os << "CRITICAL";
-		break;
+		return "CRITICAL";
 	case LogLevel::Fatal:
-		os << "FATAL";
-		break;
+		return "FATAL";
 	default:
-		throw make_exception(logLevel, " is an invalid value for the LogLevel enum!");
+		return{};
+	}
+}
+
+inline std::ostream& operator<<(std::ostream& os, const LogLevel& logLevel)
+{
+	const auto name{ get_name(logLevel) };
+	if (name.empty())
+		throw make_exception(static_cast<int>(logLevel), " is an invalid value for the LogLevel enum!");
+	return os << name;
+}
+
+/**
+ * @brief			Parses a log level from its (case-insensitive) name.
+ * @param text	  -	The name of a log level, or "warning".
+ * @returns			The log level with the specified name.
+ */
+inline LogLevel parse_log_level(std::string_view text) noexcept(false)
+{
+	std::string name{ text };
+	for (auto& ch : name) {
+		ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+	}
+	if (name == "WARNING")
+		return LogLevel::Warning;
+	for (const auto level : { LogLevel::Trace, LogLevel::Debug, LogLevel::Info, LogLevel::Warning, LogLevel::Error, LogLevel::Critical, LogLevel::Fatal }) {
+		if (name == get_name(level))
+			return level;
 	}
-	return os;
+	throw make_exception("Invalid log level \"", text, "\"; expected \"trace\", \"debug\", \"info\", \"warning\", \"error\", \"critical\", or \"fatal\"!");
 }
 
+/**
+ * @brief	Starts a log message of the specified level; use in place of std::clog << MessageHeader(level).
+ *\n		When the level is filtered out, the rest of the expression isn't evaluated.
+ */
+#define ARRCON_LOG(level) for (bool arrcon_log_enabled_{ is_log_enabled(level) }; arrcon_log_enabled_; arrcon_log_enabled_ = false) std::clog << MessageHeader(level)
+
 struct MessageHeader {
 	LogLevel level;
 
 	friend std::ostream& operator<<(std::ostream& os, const MessageHeader& m)
 	{
-		const auto timestamp{ boost::posix_time::to_iso_string(boost::posix_time::second_clock::universal_time()) };
-		const auto level{ str::stringify(m.level) };
+		// the timestamp only has a resolution of one second, so it is only formatted once per second
+		thread_local std::time_t cachedTime{ -1 };
+		thread_local std::string timestamp;
+		if (const auto now{ std::time(nullptr) }; now != cachedTime) {
+			cachedTime = now;
+			timestamp = boost::posix_time::to_iso_string(boost::posix_time::from_time_t(now));
+		}
+		const auto level{ get_name(m.level) };
 		return os
 			<< timestamp << indent(LM_TIMESTAMP, timestamp.size())
 			<< '[' << level << ']' << indent(LM_LEVEL, level.size() + 2);
@@ -75,31 +136,217 @@ struct BlankHeader {
 	}
 };
 
+/**
+ * @class	AsyncLogBuffer
+ * @brief	Stream buffer that hands completed log records to a background thread, which writes them to another stream buffer in batches.
+ *\n		Characters are staged in a thread-local buffer until the stream is flushed (i.e. by std::endl), then the record is pushed
+ *			 into a bounded lock-free ring. The destination is only flushed once per batch, rather than once per line.
+ *\n		All pending records are written before the destructor returns.
+ */
+class AsyncLogBuffer : public std::streambuf {
+	/// @brief	The maximum number of records that may be waiting to be written. Must be a power of two.
+	static constexpr size_t CAPACITY{ 1024 };
+
+	struct slot {
+		/// @brief	Equal to the slot's position when it is free, and to the position + 1 when it holds a record.
+		std::atomic<size_t> sequence;
+		std::string record;
+	};
+
+	std::streambuf* destination;
+	std::array<slot, CAPACITY> ring;
+	alignas(64) std::atomic<size_t> head{ 0 };	//< the next position to push to
+	alignas(64) size_t tail{ 0 };				//< the next position to pop from; only used by the writer thread
+	/// @brief	Incremented whenever a record is pushed, so that the writer thread can wait for it to change.
+	std::atomic<uint32_t> pushed{ 0 };
+	std::atomic<bool> stopping{ false };
+	/// @brief	The writer thread is only started when the first record is pushed, so that runs which don't log anything don't start it.
+	std::once_flag writerStarted;
+	std::thread writer;
+
+	/// @brief	Gets the calling thread's partially-written record.
+	static std::string& staging()
+	{
+		thread_local std::string buffer;
+		return buffer;
+	}
+
+	/// @brief	Moves a record into the ring, waiting for the writer thread to make room if it is full.
+	void push(std::string&& record)
+	{
+		std::call_once(writerStarted, [this] { writer = std::thread([this] { run(); }); });
+
+		size_t pos{ head.load(std::memory_order_relaxed) };
+		while (true) {
+			slot& s{ ring[pos & (CAPACITY - 1)] };
+			const auto diff{ static_cast<intptr_t>(s.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos) };
+			if (diff == 0) {
+				if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					s.record = std::move(record);
+					s.sequence.store(pos + 1, std::memory_order_release);
+					break;
+				}
+			}
+			else if (diff < 0) { // full
+				std::this_thread::yield();
+				pos = head.load(std::memory_order_relaxed);
+			}
+			else pos = head.load(std::memory_order_relaxed);
+		}
+		pushed.fetch_add(1, std::memory_order_release);
+		pushed.notify_one();
+	}
+	/// @brief	Writes every record in the ring to the destination, then flushes it.
+	/// @returns	true when at least one record was written; otherwise false.
+	bool drain()
+	{
+		bool any{ false };
+		while (true) {
+			slot& s{ ring[tail & (CAPACITY - 1)] };
+			if (s.sequence.load(std::memory_order_acquire) != tail + 1)
+				break;
+			destination->sputn(s.record.data(), static_cast<std::streamsize>(s.record.size()));
+			s.record.clear();
+			s.sequence.store(tail + CAPACITY, std::memory_order_release);
+			++tail;
+			any = true;
+		}
+		if (any)
+			destination->pubsync();
+		return any;
+	}
+	void run()
+	{
+		while (true) {
+			const auto seen{ pushed.load(std::memory_order_acquire) };
+			drain();
+			if (stopping.load(std::memory_order_acquire))
+				break;
+			pushed.wait(seen, std::memory_order_acquire);
+		}
+		drain();
+	}
+
+protected:
+	int_type overflow(int_type ch) override
+	{
+		if (!traits_type::eq_int_type(ch, traits_type::eof()))
+			staging().push_back(traits_type::to_char_type(ch));
+		return traits_type::not_eof(ch);
+	}
+	std::streamsize xsputn(const char_type* s, std::streamsize count) override
+	{
+		staging().append(s, static_cast<size_t>(count));
+		return count;
+	}
+	int sync() override
+	{
+		if (auto& buffer{ staging() }; !buffer.empty()) {
+			push(std::move(buffer));
+			buffer = {};
+		}
+		return 0;
+	}
+
+public:
+	AsyncLogBuffer(std::streambuf* destination) : destination{ destination }
+	{
+		for (size_t i{ 0 }; i < CAPACITY; ++i) {
+			ring[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	~AsyncLogBuffer()
+	{
+		sync();
+		std::call_once(writerStarted, [] {}); //< synchronizes with a writer thread started by another thread
+		if (!writer.joinable())
+			return;
+		stopping.store(true, std::memory_order_release);
+		pushed.fetch_add(1, std::memory_order_release);
+		pushed.notify_one();
+		writer.join();
+	}
+};
+
+/**
+ * @class	LazyFileBuffer
+ * @brief	File stream buffer that doesn't create (or truncate) the file until the first character is written to it.
+ *\n		The location of the file is only determined then too, since finding it may require probing the filesystem.
+ */
+class LazyFileBuffer : public std::streambuf {
+	std::function<std::filesystem::path()> getPath;
+	/// @brief	Text that is written to the start of the file when it is created.
+	std::string preamble;
+	std::filebuf file;
+	bool opened{ false };
+
+	/// @brief	Creates the file on the first call. Returns true when the file is open.
+	bool open()
+	{
+		if (!opened) {
+			opened = true;
+			if (file.open(getPath(), std::ios::out | std::ios::trunc))
+				file.sputn(preamble.data(), static_cast<std::streamsize>(preamble.size()));
+		}
+		return file.is_open();
+	}
+
+protected:
+	int_type overflow(int_type ch) override
+	{
+		if (traits_type::eq_int_type(ch, traits_type::eof()))
+			return traits_type::not_eof(ch);
+		if (!open())
+			return traits_type::eof();
+		return file.sputc(traits_type::to_char_type(ch));
+	}
+	std::streamsize xsputn(const char_type* s, std::streamsize count) override
+	{
+		if (!open())
+			return 0;
+		return file.sputn(s, count);
+	}
+	int sync() override
+	{
+		return file.is_open() ? file.pubsync() : 0;
+	}
+
+public:
+	/**
+	 * @brief				Creates a new LazyFileBuffer instance without creating the file.
+	 * @param getPath	  -	Function that determines the location of the file. It is called on the thread that first writes to the buffer.
+	 * @param preamble	  -	Text that is written to the start of the file when it is created.
+	 */
+	LazyFileBuffer(std::function<std::filesystem::path()> getPath, std::string preamble = {}) : getPath{ std::move(getPath) }, preamble{ std::move(preamble) } {}
+};
+
 /**
  * @class	Logger
- * @brief	Manager object that handles swapping the read buffer of std::clog with another one.
- *			The read buffer is swapped back in the destructor.
+ * @brief	Manager object that handles swapping the read buffer of std::clog with an AsyncLogBuffer that writes to another one.
+ *			The read buffer is swapped back, and pending log records are written, in the destructor.
  */
 class Logger {
+	AsyncLogBuffer asyncBuffer;
 	std::streambuf* original_clog_rdbuf;
 
 public:
-	Logger(std::streambuf* rdbuf) : original_clog_rdbuf{ std::clog.rdbuf() }
+	Logger(std::streambuf* rdbuf) : asyncBuffer{ rdbuf }, original_clog_rdbuf{ std::clog.rdbuf() }
 	{
 		// swap clog rdbuf
-		std::clog.rdbuf(rdbuf);
+		std::clog.rdbuf(&asyncBuffer);
 	}
 	~Logger()
 	{
 		// reset clog rdbuf
 		std::clog.rdbuf(original_clog_rdbuf);
+		// asyncBuffer writes any pending records when it is destroyed
 	}
 
 	/**
-	 * @brief	Prints a header line that indicates the segments of a log message.
+	 * @brief	Gets the header line that indicates the segments of a log message, which is written to the start of the log file.
 	 */
-	void print_header() const
+	static std::string get_header()
 	{
-		std::clog << "YYYYMMDDTHHMMSS" << indent(LM_TIMESTAMP, 15) << "LEVEL" << indent(LM_LEVEL, 5) << "MESSAGE" << std::endl;
+		return str::stringify("YYYYMMDDTHHMMSS", indent(LM_TIMESTAMP, 15), "LEVEL", indent(LM_LEVEL, 5), "MESSAGE", '\n');
 	}
 };
@@ -0,0 +1,127 @@
+#pragma once
+#include "../logging.hpp"
+
+// Boost::asio
+#include <boost/asio/any_io_executor.hpp>	//< for boost::asio::any_io_executor
+#include <boost/asio/awaitable.hpp>			//< for boost::asio::awaitable
+#include <boost/asio/io_context.hpp>		//< for boost::asio::io_context
+#include <boost/asio/ip/tcp.hpp>			//< for boost::asio::ip::tcp
+#include <boost/asio/post.hpp>				//< for boost::asio::post
+#include <boost/asio/redirect_error.hpp>	//< for boost::asio::redirect_error
+#include <boost/asio/steady_timer.hpp>		//< for boost::asio::steady_timer
+#include <boost/asio/this_coro.hpp>			//< for boost::asio::this_coro
+#include <boost/asio/use_awaitable.hpp>		//< for boost::asio::use_awaitable
+
+// STL
+#include <chrono>				//< for std::chrono
+#include <memory>				//< for std::shared_ptr
+#include <mutex>				//< for std::mutex
+#include <optional>				//< for std::optional
+#include <string>				//< for std::string
+#include <string_view>			//< for std::string_view
+#include <thread>				//< for std::thread
+#include <vector>				//< for std::vector, std::erase_if
+
+namespace net {
+	/**
+	 * @class	BackgroundResolver
+	 * @brief	Resolves a target on a background thread, so that DNS resolution overlaps with the rest of startup.
+	 *\n		The background thread is detached, so abandoning the resolver never waits for the resolution to finish.
+	 *			 Coroutines wait for it asynchronously, so other operations on the same I/O context continue in the meantime.
+	 */
+	class BackgroundResolver {
+		using tcp = boost::asio::ip::tcp;
+
+		/// @brief	A coroutine that is waiting for the resolution to finish; its timer is cancelled to wake it.
+		struct waiter {
+			boost::asio::any_io_executor executor;
+			std::shared_ptr<boost::asio::steady_timer> timer;
+		};
+
+		struct shared_state {
+			std::mutex mutex;
+			std::vector<waiter> waiters;
+			bool done{ false };
+			std::vector<tcp::endpoint> endpoints;
+			std::string error;
+		};
+
+		std::string host;
+		std::string port;
+		std::shared_ptr<shared_state> state;
+
+	public:
+		/**
+		 * @brief			Starts resolving the specified target on a background thread.
+		 * @param host	  -	The target hostname.
+		 * @param port	  -	The target port.
+		 */
+		BackgroundResolver(std::string host, std::string port) : host{ std::move(host) }, port{ std::move(port) }, state{ std::make_shared<shared_state>() }
+		{
+			std::thread([state = state, host = this->host, port = this->port] {
+				std::vector<tcp::endpoint> endpoints;
+				std::string error;
+				try {
+					boost::asio::io_context ioContext;
+					tcp::resolver resolver{ ioContext };
+					for (const auto& result : resolver.resolve(host, port)) {
+						endpoints.emplace_back(result.endpoint());
+					}
+				} catch (std::exception const& ex) {
+					error = ex.what();
+				}
+				std::scoped_lock lock{ state->mutex };
+				state->endpoints = std::move(endpoints);
+				state->error = std::move(error);
+				state->done = true;
+				// wake the waiters while holding the lock, since each waiter's I/O context may be destroyed once it stops waiting
+				for (const auto& w : state->waiters) {
+					boost::asio::post(w.executor, [timer = w.timer] { timer->cancel(); });
+				}
+				state->waiters.clear();
+			}).detach();
+		}
+
+		/// @brief	Checks whether this resolver is resolving the specified target.
+		bool matches(std::string_view const host, std::string_view const port) const noexcept
+		{
+			return this->host == host && this->port == port;
+		}
+
+		/**
+		 * @brief				Waits for the resolution to finish, until the specified deadline.
+		 * @param deadline	  -	The latest time to wait until.
+		 * @returns				The resolved endpoints when successful; otherwise, std::nullopt, in which case the target should be resolved again
+		 *						 so that the failure is reported normally.
+		 */
+		boost::asio::awaitable<std::optional<std::vector<tcp::endpoint>>> async_wait_until(std::chrono::steady_clock::time_point const deadline)
+		{
+			const auto executor{ co_await boost::asio::this_coro::executor };
+			const auto timer{ std::make_shared<boost::asio::steady_timer>(executor, deadline) };
+
+			bool done{ false };
+			{
+				std::scoped_lock lock{ state->mutex };
+				done = state->done;
+				if (!done)
+					state->waiters.emplace_back(executor, timer);
+			}
+			if (!done) {
+				boost::system::error_code ec;
+				co_await timer->async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+			}
+
+			std::scoped_lock lock{ state->mutex };
+			if (!state->done) {
+				// timed out; stop the background thread from waking this coroutine
+				std::erase_if(state->waiters, [&timer](waiter const& w) { return w.timer == timer; });
+				co_return std::nullopt;
+			}
+			if (!state->error.empty() || state->endpoints.empty()) {
+				ARRCON_LOG(LogLevel::Debug) << "Background DNS resolution of \"" << host << ':' << port << "\" failed: " << state->error << std::endl;
+				co_return std::nullopt;
+			}
+			co_return state->endpoints;
+		}
+	};
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include "rcon.hpp"
+#include "target_info.hpp"
+#include "stats.hpp"
+
+// Boost::asio
+#include <boost/asio/detached.hpp>	//< for boost::asio::detached
+
+// STL
+#include <algorithm>	//< for std::min, std::max
+#include <chrono>		//< for std::chrono
+#include <functional>	//< for std::function
+#include <memory>		//< for std::unique_ptr
+#include <string>		//< for std::string
+#include <vector>		//< for std::vector
+
+namespace net::rcon {
+	struct bench_settings {
+		/// @brief	The total number of commands to send.
+		size_t count{ 1000 };
+		/// @brief	The number of connections to send commands over concurrently.
+		size_t connections{ 1 };
+		/// @brief	The target number of commands per second across all connections, or 0 to send them as fast as possible.
+		double rate{ 0.0 };
+		/// @brief	The amount of time between each progress report.
+		std::chrono::milliseconds reportInterval{ 1000 };
+		/// @brief	The number of milliseconds that DNS resolution & connecting may take.
+		int connect_timeout_ms{ 3000 };
+		/// @brief	The number of milliseconds to wait before trying the next resolved address of the target.
+		int connect_delay_ms{ 250 };
+		/// @brief	The number of milliseconds that authentication may take.
+		int auth_timeout_ms{ 3000 };
+		/// @brief	The number of milliseconds to wait for the complete response to each command.
+		int command_timeout_ms{ 3000 };
+		/// @brief	The words that are repeated before each part of a split Minecraft command, or empty to never split them.
+		std::string splitPrefix;
+		/// @brief	Optional cache of resolved endpoints, or nullptr to always resolve targets.
+		DnsCache* dnsCache{ nullptr };
+		/// @brief	Optional statistics that the statistics of every connection are merged into, or nullptr.
+		client_stats* stats{ nullptr };
+	};
+
+	/// @brief	The results of a benchmark, or of one reporting interval of a benchmark.
+	struct bench_results {
+		/// @brief	The amount of time since the benchmark started.
+		std::chrono::steady_clock::duration elapsed{};
+		/// @brief	The amount of time that these results cover.
+		std::chrono::steady_clock::duration duration{};
+		uint64_t completed{ 0 };
+		uint64_t errors{ 0 };
+		/// @brief	The latency of each completed command. When a rate is set, latency is measured from when the command was
+		///			 scheduled to be sent rather than when it was actually sent, so that a slow server can't hide queueing delays.
+		latency_histogram latency;
+
+		/// @brief	Gets the number of completed commands per second.
+		double throughput() const noexcept
+		{
+			const auto seconds{ std::chrono::duration<double>(duration).count() };
+			return seconds > 0.0 ? static_cast<double>(completed) / seconds : 0.0;
+		}
+	};
+
+	/**
+	 * @brief				Sends commands to a target over several connections as fast as possible, or at a fixed rate, and measures the results.
+	 *\n					All connections are driven by a single io_context on the calling thread; callbacks are invoked on the calling thread.
+	 * @param target	  -	The target to benchmark.
+	 * @param commands	  -	The commands to send. Commands are sent in a loop until the total count is reached.
+	 * @param settings	  -	The settings to use.
+	 * @param onReport	  -	Callback that is invoked with the results of each reporting interval.
+	 * @returns				The results of the entire benchmark.
+	 */
+	inline bench_results bench(target_info const& target,
+							   std::vector<std::string> const& commands,
+							   bench_settings const& settings,
+							   std::function<void(bench_results const&)> const& onReport) noexcept(false)
+	{
+		if (commands.empty())
+			throw make_exception("Benchmark mode requires at least one command!");
+
+		io_context ioContext;
+		const auto start{ std::chrono::steady_clock::now() };
+		const auto connectionCount{ std::min(std::max(settings.connections, size_t{ 1 }), std::max(settings.count, size_t{ 1 })) };
+
+		size_t next{ 0 }, activeWorkers{ connectionCount };
+		bench_results total, interval;
+		auto intervalStart{ start };
+
+		const auto record{ [&](std::chrono::steady_clock::duration const latency, bool const failed) {
+			if (failed) {
+				++total.errors;
+				++interval.errors;
+				return;
+			}
+			++total.completed;
+			++interval.completed;
+			total.latency.record(latency);
+			interval.latency.record(latency);
+		} };
+		const auto report{ [&] {
+			const auto now{ std::chrono::steady_clock::now() };
+			interval.elapsed = now - start;
+			interval.duration = now - intervalStart;
+			onReport(interval);
+			interval = {};
+			intervalStart = now;
+		} };
+
+		// each worker sends commands over its own connection until the total count is reached
+		const auto worker{ [&]() -> awaitable<void> {
+			std::unique_ptr<RconClient> client;
+			boost::asio::steady_timer timer{ ioContext };
+
+			while (next < settings.count) {
+				const size_t index{ next++ };
+
+				// wait until the command is scheduled to be sent
+				auto scheduled{ std::chrono::steady_clock::now() };
+				if (settings.rate > 0.0) {
+					scheduled = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(static_cast<double>(index) / settings.rate));
+					timer.expires_at(scheduled);
+					boost::system::error_code ec;
+					co_await timer.async_wait(boost::asio::redirect_error(use_awaitable, ec));
+				}
+
+				try {
+					if (!client) {
+						auto newClient{ std::make_unique<RconClient>(ioContext) };
+						newClient->set_connect_timeout(settings.connect_timeout_ms);
+						newClient->set_connect_attempt_delay(settings.connect_delay_ms);
+						newClient->set_auth_timeout(settings.auth_timeout_ms);
+						newClient->set_command_timeout(settings.command_timeout_ms);
+						newClient->set_response_end(target.responseEnd);
+						newClient->set_dialect(target.dialect);
+						newClient->set_split_prefix(settings.splitPrefix);
+						newClient->set_dns_cache(settings.dnsCache);
+
+						co_await newClient->async_connect(target.host, target.port);
+						const bool authenticated{ co_await newClient->async_authenticate(target.pass) };
+						if (!authenticated)
+							throw make_exception("Authentication Error:  Incorrect Password!");
+						client = std::move(newClient);
+					}
+					// without a rate, latency is measured from when the command is sent, so it doesn't include connecting & authenticating
+					if (settings.rate <= 0.0)
+						scheduled = std::chrono::steady_clock::now();
+
+					co_await client->async_command(commands[index % commands.size()], [](std::string_view) {});
+					record(std::chrono::steady_clock::now() - scheduled, false);
+				} catch (std::exception const& ex) {
+					ARRCON_LOG(LogLevel::Error) << "Command #" << index << " failed: " << ex.what() << std::endl;
+					record({}, true);
+					// the connection is in an unknown state; reconnect before sending the next command
+					if (client && settings.stats)
+						settings.stats->merge(client->get_stats());
+					client.reset();
+				}
+			}
+
+			if (client && settings.stats)
+				settings.stats->merge(client->get_stats());
+
+			if (--activeWorkers == 0) // the last worker stops the reporter
+				ioContext.stop();
+		} };
+		const auto reporter{ [&]() -> awaitable<void> {
+			boost::asio::steady_timer timer{ ioContext };
+			for (auto reportAt{ start + settings.reportInterval };; reportAt += settings.reportInterval) {
+				timer.expires_at(reportAt);
+				co_await timer.async_wait(use_awaitable);
+				report();
+			}
+		} };
+
+		for (size_t i{ 0 }; i < connectionCount; ++i) {
+			boost::asio::co_spawn(ioContext, worker(), boost::asio::detached);
+		}
+		if (settings.reportInterval.count() > 0)
+			boost::asio::co_spawn(ioContext, reporter(), boost::asio::detached);
+
+		ARRCON_LOG(LogLevel::Debug) << "Benchmarking " << target << " with " << settings.count << " command" << (settings.count == 1 ? "" : "s") << " over " << connectionCount << " connection" << (connectionCount == 1 ? "" : "s") << '.' << std::endl;
+
+		ioContext.run();
+
+		// report the final partial interval
+		if (settings.reportInterval.count() > 0 && (interval.completed > 0 || interval.errors > 0))
+			report();
+
+		total.elapsed = total.duration = std::chrono::steady_clock::now() - start;
+		return total;
+	}
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include "../ExceptionBuilder.hpp"
+#include "packet.hpp"
+#include "response_end.hpp"
+
+// 307lib::shared
+#include <strcore.hpp>	//< for str::equalsAny
+
+// STL
+#include <algorithm>	//< for std::min
+#include <cstdint>		//< for sized integer types
+#include <optional>		//< for std::optional
+#include <ostream>		//< for std::ostream
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
+
+namespace net::rcon {
+	/// @brief	Server dialects, which determine how large a command may be and how oversized commands are split into multiple packets.
+	enum class Dialect : uint8_t {
+		/// @brief	Commands are always sent in a single packet, regardless of their size.
+		None,
+		/// @brief	Source engine servers; oversized commands are split at the ';' separators between console commands.
+		Source,
+		/// @brief	Minecraft servers; oversized commands are split at whitespace, and the split prefix is repeated before each part.
+		///			 Commands are only split when a split prefix is set, since most commands can't be split safely.
+		Minecraft,
+	};
+
+	/// @brief	The body size of a command packet of the largest size that servers are expected to accept.
+	inline constexpr const size_t MAX_COMMAND_BODY_SIZE{ PACKETSZ_MAX_SEND - (sizeof(packet_header) - sizeof(int32_t)) - PACKET_TERMINATOR.size() };
+	/// @brief	The body size of the largest command packet that Minecraft servers accept; larger packets are dropped.
+	inline constexpr const size_t MINECRAFT_MAX_COMMAND_BODY_SIZE{ 1446 };
+	/// @brief	The body size of a response packet that was filled completely by a Minecraft server, which splits responses into 4096-byte fragments.
+	inline constexpr const size_t MINECRAFT_RESPONSE_FRAGMENT_BODY_SIZE{ 4096 };
+
+	/**
+	 * @brief			Parses a dialect from its name.
+	 * @param text	  -	The name of the dialect; case-insensitive.
+	 * @returns			The dialect when successful; otherwise, std::nullopt.
+	 */
+	inline std::optional<Dialect> parse_dialect(std::string_view const text)
+	{
+		const std::string name{ text };
+		if (str::equalsAny<false>(name, "none"))
+			return Dialect::None;
+		else if (str::equalsAny<false>(name, "source"))
+			return Dialect::Source;
+		else if (str::equalsAny<false>(name, "minecraft"))
+			return Dialect::Minecraft;
+		return std::nullopt;
+	}
+
+	inline std::ostream& operator<<(std::ostream& os, Dialect const dialect)
+	{
+		switch (dialect) {
+		case Dialect::None:
+			return os << "none";
+		case Dialect::Source:
+			return os << "source";
+		case Dialect::Minecraft:
+			return os << "minecraft";
+		}
+		return os;
+	}
+
+	/// @brief	Gets the largest command body that the specified dialect sends in a single packet.
+	inline constexpr size_t get_max_command_body_size(Dialect const dialect) noexcept
+	{
+		return dialect == Dialect::Minecraft ? MINECRAFT_MAX_COMMAND_BODY_SIZE : MAX_COMMAND_BODY_SIZE;
+	}
+	/// @brief	Gets the body size of a full response fragment from a server of the specified dialect; smaller response packets are the last of their response.
+	inline constexpr size_t get_response_fragment_body_size(Dialect const dialect) noexcept
+	{
+		return dialect == Dialect::Minecraft ? MINECRAFT_RESPONSE_FRAGMENT_BODY_SIZE : RESPONSE_FRAGMENT_BODY_SIZE;
+	}
+
+	/**
+	 * @class	command_splitter
+	 * @brief	Splits a command into parts that each fit in a single command packet, according to the rules of a dialect.
+	 *\n		Parts are views into the command, so the command is never copied; each part is sent as the body that follows a prefix,
+	 *			 which is the split prefix (e.g. "say") for the Minecraft dialect and empty otherwise. Parts that are empty are skipped.
+	 */
+	class command_splitter {
+		static constexpr std::string_view WHITESPACE{ " \t\r\n\v\f" };
+		/// @brief	The characters between the console commands of a Source command.
+		static constexpr std::string_view SOURCE_SEPARATORS{ " \t\r\n\v\f;" };
+
+		Dialect dialect;
+		size_t limit;
+		/// @brief	The text that is repeated before each part.
+		std::string_view repeated;
+		std::string_view rest;
+		bool single;
+		bool done{ false };
+
+		[[noreturn]] void throw_unsplittable() const noexcept(false)
+		{
+			throw make_exception("Can't split a command of ", repeated.size() + rest.size(), " bytes into packets of up to ", limit, " bytes with the ", dialect, " dialect!");
+		}
+
+		/**
+		 * @brief		Finds the last ';' that separates two console commands, ignoring separators between double quotes.
+		 * @returns		The position of the separator within the first limit bytes of rest, or std::string_view::npos when there isn't one.
+		 */
+		size_t find_separator() const noexcept
+		{
+			size_t last{ std::string_view::npos };
+			bool quoted{ false };
+			for (size_t i{ 0 }, end{ std::min(rest.size(), limit + 1) }; i < end; ++i) {
+				if (rest[i] == '"')
+					quoted = !quoted;
+				else if (rest[i] == ';' && !quoted)
+					last = i;
+			}
+			return last;
+		}
+
+	public:
+		/**
+		 * @brief				Prepares to split the specified command.
+		 * @param command	  -	The command to split. This must outlive the splitter.
+		 * @param dialect	  -	The dialect of the server that the command is sent to.
+		 * @param splitPrefix -	The words that are repeated before each part of a Minecraft command, which the command must start with.
+		 *						 When this is empty, Minecraft commands that are too large for a single packet can't be split.
+		 */
+		command_splitter(std::string_view const command, Dialect const dialect, std::string_view splitPrefix = {}) noexcept(false) : dialect{ dialect }, limit{ get_max_command_body_size(dialect) }, rest{ command }, single{ dialect == Dialect::None || command.size() <= limit }
+		{
+			if (single || dialect != Dialect::Minecraft)
+				return;
+
+			// only the split prefix is repeated before each part, e.g. "say <text>" becomes several "say" commands; repeating
+			//  anything else would change the meaning of commands like "whitelist add <names>", so they aren't split by default
+			if (const auto last{ splitPrefix.find_last_not_of(WHITESPACE) }; last != std::string_view::npos)
+				splitPrefix = splitPrefix.substr(0, last + 1);
+			else throw make_exception("Can't send a command of ", command.size(), " bytes in a single packet with the ", dialect, " dialect, and it can't be split without a split prefix!");
+			if (!command.starts_with(splitPrefix) || command.size() == splitPrefix.size() || WHITESPACE.find(command[splitPrefix.size()]) == std::string_view::npos)
+				throw make_exception("Can't split a command of ", command.size(), " bytes with the ", dialect, " dialect, because it doesn't start with the split prefix \"", splitPrefix, "\"!");
+
+			const auto argsBegin{ command.find_first_not_of(WHITESPACE, splitPrefix.size()) };
+			if (argsBegin == std::string_view::npos || argsBegin >= limit)
+				throw_unsplittable();
+			repeated = command.substr(0, argsBegin);
+			rest = command.substr(argsBegin);
+		}
+
+		/// @brief	Checks whether the command fits in a single packet, and isn't split at all.
+		bool is_single() const noexcept { return single; }
+
+		/**
+		 * @brief			Gets the next part of the command.
+		 * @param prefix  -	Receives the text that must be sent before the part, in the same packet.
+		 * @param part	  -	Receives the next part of the command.
+		 * @returns			true when a part was found; false when the whole command was split.
+		 */
+		bool next(std::string_view& prefix, std::string_view& part) noexcept(false)
+		{
+			if (done)
+				return false;
+			if (single) {
+				prefix = {};
+				part = rest;
+				done = true;
+				return true;
+			}
+
+			while (true) {
+				// skip the separators & whitespace between the previous part and this one
+				const auto separators{ dialect == Dialect::Source ? SOURCE_SEPARATORS : WHITESPACE };
+				if (const auto begin{ rest.find_first_not_of(separators) }; begin == std::string_view::npos) {
+					done = true;
+					return false;
+				}
+				else rest.remove_prefix(begin);
+
+				const size_t room{ limit - repeated.size() };
+				size_t end{ rest.size() };
+				if (rest.size() > room) {
+					if (dialect == Dialect::Source) {
+						end = find_separator();
+						if (end == std::string_view::npos)
+							throw_unsplittable();
+					}
+					else if (end = rest.find_last_of(WHITESPACE, room); end == std::string_view::npos) {
+						// a single word is longer than a packet, so split it without breaking up a UTF-8 sequence
+						end = room;
+						while (end > 0 && (static_cast<unsigned char>(rest[end]) & 0xC0) == 0x80) {
+							--end;
+						}
+						if (end == 0)
+							throw_unsplittable();
+					}
+				}
+
+				part = rest.substr(0, end);
+				rest.remove_prefix(end);
+				// trim trailing separators, and never send a part that is only separators as an empty command
+				if (const auto last{ part.find_last_not_of(separators) }; last == std::string_view::npos)
+					continue;
+				else part = part.substr(0, last + 1);
+				prefix = repeated;
+				return true;
+			}
+		}
+
+		/// @brief	Gets the number of packets that the command is split into.
+		size_t count() const noexcept(false)
+		{
+			auto copy{ *this };
+			size_t n{ 0 };
+			for (std::string_view prefix, part; copy.next(prefix, part);) {
+				++n;
+			}
+			return n;
+		}
+	};
+}
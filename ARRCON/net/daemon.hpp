@@ -0,0 +1,531 @@
+#pragma once
+#include "rcon.hpp"
+#include "target_info.hpp"
+
+// Boost::asio
+#include <boost/asio/detached.hpp>		//< for boost::asio::detached
+#include <boost/asio/signal_set.hpp>	//< for boost::asio::signal_set
+#include <boost/asio/local/stream_protocol.hpp>	//< for boost::asio::local::stream_protocol
+#include <boost/asio/steady_timer.hpp>	//< for boost::asio::steady_timer
+
+// STL
+#include <array>		//< for std::array
+#include <charconv>		//< for std::from_chars
+#include <chrono>		//< for std::chrono
+#include <deque>		//< for std::deque
+#include <exception>	//< for std::exception_ptr
+#include <filesystem>	//< for std::filesystem
+#include <functional>	//< for std::function
+#include <map>			//< for std::map
+#include <memory>		//< for std::unique_ptr
+#include <string>		//< for std::string
+#include <unordered_set>	//< for std::unordered_set
+#include <utility>		//< for std::exchange
+#include <vector>		//< for std::vector
+
+#ifndef _WIN32
+#include <sys/stat.h>	//< for umask
+#endif
+
+/**
+ * @brief	Persistent session daemon that holds authenticated connections, and the thin client used to send commands through it.
+ *\n		Requests and responses are exchanged over a local (Unix domain) socket as frames, each of which
+ *			 consists of a 1-byte frame type, a 4-byte body size, and the body.
+ */
+namespace net::daemon {
+	/// @brief	The types of frames that are exchanged between the daemon and its clients.
+	enum class FrameType : uint8_t {
+		/// @brief	(Request) The target to send commands to. The body contains the host, port, password, response end strategy, dialect, split prefix,
+		///			 and the connect timeout, connect delay, authentication timeout & command timeout in milliseconds, separated by null bytes.
+		Target = 'T',
+		/// @brief	(Request) A command to send to the target.
+		Command = 'C',
+		/// @brief	(Request) Marks the end of the request.
+		End = 'E',
+		/// @brief	(Response) The response to the current command.
+		Data = 'D',
+		/// @brief	(Response) Marks the end of the response to the current command.
+		Done = 'R',
+		/// @brief	(Response) An error occurred. The body contains the error message, and no more frames follow.
+		Error = 'X',
+	};
+
+	/// @brief	The size of a frame header, which consists of the frame type followed by the size of the body.
+	inline constexpr size_t FRAME_HEADER_SIZE{ sizeof(uint8_t) + sizeof(uint32_t) };
+	/// @brief	The largest frame body that will be accepted.
+	inline constexpr uint32_t FRAME_MAX_SIZE{ 64 * 1024 * 1024 };
+
+	/// @brief	The timeouts that the daemon uses for a request, which are chosen by the instance that sent it.
+	struct request_timeouts {
+		/// @brief	The number of milliseconds that DNS resolution & connecting to the target may take.
+		int connect_timeout_ms{ 3000 };
+		/// @brief	The number of milliseconds to wait before trying the next resolved address of the target.
+		int connect_delay_ms{ 250 };
+		/// @brief	The number of milliseconds that authenticating with the target may take.
+		int auth_timeout_ms{ 3000 };
+		/// @brief	The number of milliseconds to wait for the complete response to each command.
+		int command_timeout_ms{ 3000 };
+	};
+
+	/**
+	 * @brief			Appends a frame to the specified buffer.
+	 * @param buf	  -	The buffer to append the frame to.
+	 * @param type	  -	The type of frame.
+	 * @param body	  -	The body of the frame.
+	 */
+	inline void append_frame(std::string& buf, FrameType const type, std::string_view body)
+	{
+		const uint32_t size{ static_cast<uint32_t>(body.size()) };
+		buf.push_back(static_cast<char>(type));
+		buf.append(reinterpret_cast<char const*>(&size), sizeof(uint32_t));
+		buf.append(body);
+	}
+
+	/**
+	 * @brief			Parses a frame header.
+	 * @param header  -	The raw frame header.
+	 * @returns			A pair containing the frame type and the size of the frame body.
+	 */
+	inline std::pair<FrameType, uint32_t> parse_frame_header(std::array<uint8_t, FRAME_HEADER_SIZE> const& header) noexcept(false)
+	{
+		uint32_t size;
+		std::memcpy(&size, header.data() + sizeof(uint8_t), sizeof(uint32_t));
+
+		if (size > FRAME_MAX_SIZE)
+			throw make_exception("Received a daemon frame with an invalid size of ", size, " bytes!");
+
+		return{ static_cast<FrameType>(header[0]), size };
+	}
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	using boost::asio::local::stream_protocol;
+
+	/// @brief	Reads a single frame from the specified local socket.
+	inline awaitable<std::pair<FrameType, std::string>> async_read_frame(stream_protocol::socket& socket) noexcept(false)
+	{
+		std::array<uint8_t, FRAME_HEADER_SIZE> header;
+		co_await boost::asio::async_read(socket, boost::asio::buffer(header), use_awaitable);
+
+		const auto [type, size] { parse_frame_header(header) };
+
+		std::string body(size, '\0');
+		co_await boost::asio::async_read(socket, boost::asio::buffer(body), use_awaitable);
+
+		co_return std::make_pair(type, std::move(body));
+	}
+
+	/**
+	 * @class	DaemonServer
+	 * @brief	Accepts requests from thin clients over a local socket and executes them using RCON connections that are kept open between requests.
+	 *\n		Each target is connected and authenticated on its first request; later requests for it only cost one round trip per command.
+	 *			 Requests for the same target are executed one at a time, while requests for different targets are executed concurrently.
+	 */
+	class DaemonServer {
+		struct held_connection {
+			std::unique_ptr<rcon::RconClient> client;
+			/// @brief	The password that the client authenticated with.
+			std::string pass;
+			/// @brief	Whether a request is currently using this connection.
+			bool locked{ false };
+			/// @brief	Requests waiting to use this connection, in arrival order. Each waiter is resumed by cancelling its timer.
+			std::deque<boost::asio::steady_timer*> waiters;
+		};
+
+		io_context ioContext;
+		std::filesystem::path socketPath;
+		stream_protocol::acceptor acceptor;
+		/// @brief	Open connections, keyed by "host:port".
+		std::map<std::string, held_connection> connections;
+		/// @brief	The sockets of the requests that are being handled.
+		std::unordered_set<stream_protocol::socket*> sessions;
+		/// @brief	Set when the daemon is being destroyed, which makes requests that are waiting for a connection fail.
+		bool stopping{ false };
+
+		/// @brief	Waits until the specified connection is available, then locks it.
+		awaitable<void> lock(held_connection& conn) noexcept(false)
+		{
+			if (stopping)
+				throw make_exception("The daemon is stopping!");
+			if (!conn.locked) {
+				conn.locked = true;
+				co_return;
+			}
+
+			boost::asio::steady_timer waiter{ ioContext, boost::asio::steady_timer::time_point::max() };
+			conn.waiters.push_back(&waiter);
+
+			boost::system::error_code ec;
+			co_await waiter.async_wait(boost::asio::redirect_error(use_awaitable, ec));
+			// the destructor wakes every waiter without passing the lock to it
+			if (stopping)
+				throw make_exception("The daemon is stopping!");
+			// ownership of the lock was passed to this request by unlock()
+		}
+		/// @brief	Unlocks the specified connection, passing it to the next waiting request (if there is one).
+		static void unlock(held_connection& conn)
+		{
+			if (conn.waiters.empty()) {
+				conn.locked = false;
+				return;
+			}
+
+			conn.waiters.front()->cancel();
+			conn.waiters.pop_front();
+		}
+
+		/**
+		 * @brief			Gets an authenticated client for the specified target, reusing the open connection when possible.
+		 * @param conn	  -	The held connection for the target. This must be locked.
+		 * @param target  -	The target to connect to.
+		 * @param timeouts -	The timeouts of the request.
+		 * @returns			The client.
+		 */
+		awaitable<rcon::RconClient*> get_client(held_connection& conn, rcon::target_info const& target, request_timeouts const& timeouts) noexcept(false)
+		{
+			if (conn.client && conn.pass == target.pass && conn.client->is_connected()) {
+				conn.client->set_command_timeout(timeouts.command_timeout_ms);
+				co_return conn.client.get();
+			}
+
+			if (conn.client)
+				ARRCON_LOG(LogLevel::Info) << "Reconnecting to " << target << '.' << std::endl;
+
+			// the new client is held while it connects, so that the destructor can close it; the connection is locked, so no other request uses it yet
+			conn.client = std::make_unique<rcon::RconClient>(ioContext);
+			conn.pass.clear();
+			auto& client{ *conn.client };
+			client.set_connect_timeout(timeouts.connect_timeout_ms);
+			client.set_connect_attempt_delay(timeouts.connect_delay_ms);
+			client.set_auth_timeout(timeouts.auth_timeout_ms);
+			client.set_command_timeout(timeouts.command_timeout_ms);
+
+			try {
+				co_await client.async_connect(target.host, target.port);
+
+				const bool authenticated{ co_await client.async_authenticate(target.pass) };
+				if (!authenticated)
+					throw make_exception("Authentication Error:  Incorrect Password!");
+			} catch (...) {
+				conn.client.reset();
+				throw;
+			}
+
+			ARRCON_LOG(LogLevel::Info) << "Authenticated with " << target << '.' << std::endl;
+
+			conn.pass = target.pass;
+			co_return conn.client.get();
+		}
+
+		/// @brief	Handles a single request from a thin client.
+		awaitable<void> session(stream_protocol::socket socket)
+		{
+			sessions.insert(&socket);
+			struct session_guard {
+				std::unordered_set<stream_protocol::socket*>& sessions;
+				stream_protocol::socket* socket;
+				~session_guard() { sessions.erase(socket); }
+			} sessionGuard{ sessions, &socket };
+
+			std::string out;
+			std::string error;
+			try {
+				// read the request
+				std::optional<rcon::target_info> target;
+				std::string splitPrefix;
+				request_timeouts timeouts;
+				std::vector<std::string> commands;
+				for (auto frame{ co_await async_read_frame(socket) }; frame.first != FrameType::End; frame = co_await async_read_frame(socket)) {
+					switch (frame.first) {
+					case FrameType::Target: {
+						// split the body into its fields
+						std::array<std::string_view, 10> fields;
+						std::string_view body{ frame.second };
+						for (size_t i{ 0 }; i < fields.size(); ++i) {
+							const auto end{ body.find('\0') };
+							if ((end == std::string_view::npos) != (i + 1 == fields.size()))
+								throw make_exception("Received a malformed target frame!");
+							fields[i] = body.substr(0, end);
+							if (end != std::string_view::npos)
+								body.remove_prefix(end + 1);
+						}
+
+						const auto responseEnd{ rcon::response_end_strategy::parse(fields[3]) };
+						if (!responseEnd.has_value())
+							throw make_exception("Received a target frame with an invalid response end strategy!");
+						const auto dialect{ rcon::parse_dialect(fields[4]) };
+						if (!dialect.has_value())
+							throw make_exception("Received a target frame with an invalid dialect!");
+						for (size_t i{ 0 }; int* const timeout : { &timeouts.connect_timeout_ms, &timeouts.connect_delay_ms, &timeouts.auth_timeout_ms, &timeouts.command_timeout_ms }) {
+							const auto field{ fields[6 + i++] };
+							if (const auto [ptr, ec] { std::from_chars(field.data(), field.data() + field.size(), *timeout) }; ec != std::errc{} || ptr != field.data() + field.size() || *timeout < 0)
+								throw make_exception("Received a target frame with an invalid timeout!");
+						}
+
+						target = rcon::target_info{
+							std::string{ fields[0] },
+							std::string{ fields[1] },
+							std::string{ fields[2] },
+							responseEnd.value(),
+							dialect.value()
+						};
+						splitPrefix = fields[5];
+						break;
+					}
+					case FrameType::Command:
+						commands.emplace_back(std::move(frame.second));
+						break;
+					default:
+						throw make_exception("Received an unexpected frame of type '", static_cast<char>(frame.first), "'!");
+					}
+				}
+				if (!target.has_value())
+					throw make_exception("The request doesn't specify a target!");
+
+				ARRCON_LOG(LogLevel::Debug) << "Received a request with " << commands.size() << " command" << (commands.size() == 1 ? "" : "s") << " for " << target.value() << '.' << std::endl;
+
+				// reject commands that can't be sent before using the connection, so that they don't cause it to be discarded
+				for (const auto& command : commands) {
+					(void)rcon::command_splitter{ command, target->dialect, splitPrefix }.count();
+				}
+
+				auto& conn{ connections[str::stringify(target->host, ':', target->port)] };
+
+				co_await lock(conn);
+				struct lock_guard {
+					held_connection& conn;
+					~lock_guard() { unlock(conn); }
+				} guard{ conn };
+
+				auto* client{ co_await get_client(conn, target.value(), timeouts) };
+				client->set_response_end(target->responseEnd);
+				client->set_dialect(target->dialect);
+				client->set_split_prefix(std::move(splitPrefix));
+
+				std::string response;
+				for (const auto& command : commands) {
+					response.clear();
+					try {
+						co_await client->async_command(command, [&response](std::string_view chunk) { response.append(chunk); });
+					} catch (std::exception const&) {
+						// the connection is in an unknown state; discard it so the next request reconnects
+						conn.client.reset();
+						throw;
+					}
+
+					// failing to reply to the thin client (e.g. because it was closed) doesn't affect the connection to the target
+					out.clear();
+					append_frame(out, FrameType::Data, response);
+					append_frame(out, FrameType::Done, {});
+					co_await boost::asio::async_write(socket, boost::asio::buffer(out), use_awaitable);
+				}
+			} catch (std::exception const& ex) {
+				ARRCON_LOG(LogLevel::Error) << "Request failed: " << ex.what() << std::endl;
+				error = ex.what();
+			}
+
+			if (!error.empty()) {
+				// report the error to the thin client, unless it's gone
+				out.clear();
+				append_frame(out, FrameType::Error, error);
+				boost::system::error_code ec;
+				co_await boost::asio::async_write(socket, boost::asio::buffer(out), boost::asio::redirect_error(use_awaitable, ec));
+			}
+		}
+
+		/// @brief	Accepts thin client connections until the daemon is stopped.
+		awaitable<void> accept_loop()
+		{
+			while (acceptor.is_open()) {
+				boost::system::error_code ec;
+				auto socket{ co_await acceptor.async_accept(boost::asio::redirect_error(use_awaitable, ec)) };
+				if (ec) {
+					if (ec == boost::asio::error::operation_aborted) break;
+					ARRCON_LOG(LogLevel::Error) << "Failed to accept a connection due to error: " << ec.message() << std::endl;
+					continue;
+				}
+
+				boost::asio::co_spawn(ioContext, session(std::move(socket)), boost::asio::detached);
+			}
+		}
+
+	public:
+		/**
+		 * @brief				Creates a new daemon that listens on the specified socket path.
+		 *\n					The timeouts of each target are chosen by the instance that sends a request for it.
+		 * @param socketPath  -	The location of the local socket to listen on.
+		 */
+		DaemonServer(std::filesystem::path const& socketPath) : socketPath{ socketPath }, acceptor{ ioContext }
+		{
+			if (std::filesystem::exists(socketPath)) {
+				// check whether another daemon is using the socket, or if it was left behind
+				stream_protocol::socket probe{ ioContext };
+				boost::system::error_code ec;
+				if (probe.connect(stream_protocol::endpoint{ socketPath.string() }, ec); !ec)
+					throw make_exception("Another daemon is already listening on ", socketPath, '!');
+
+				std::filesystem::remove(socketPath);
+			}
+			else std::filesystem::create_directories(socketPath.parent_path());
+
+			acceptor.open(stream_protocol{});
+			// only the current user may send commands through the daemon; the socket is created with these permissions, so other users can't connect before they're set
+#ifndef _WIN32
+			const auto previousMask{ ::umask(0077) };
+#endif
+			boost::system::error_code bind_ec;
+			acceptor.bind(stream_protocol::endpoint{ socketPath.string() }, bind_ec);
+#ifndef _WIN32
+			::umask(previousMask);
+#endif
+			if (bind_ec)
+				throw make_exception("Failed to bind the daemon socket ", socketPath, " due to error: ", bind_ec.message());
+			std::filesystem::permissions(socketPath, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write);
+			acceptor.listen();
+
+			ARRCON_LOG(LogLevel::Info) << "Daemon is listening on " << socketPath << '.' << std::endl;
+		}
+		~DaemonServer()
+		{
+			boost::system::error_code ec;
+			acceptor.close(ec);
+
+			// the coroutines of the requests that are in progress refer to the connections, so they must finish before the connections are destroyed;
+			//  closing every socket & waking every waiter makes them fail quickly
+			stopping = true;
+			for (auto* socket : sessions) {
+				socket->close(ec);
+			}
+			for (auto& [name, conn] : connections) {
+				if (conn.client)
+					conn.client->close();
+				for (auto* waiter : std::exchange(conn.waiters, {})) {
+					waiter->cancel();
+				}
+			}
+			ioContext.restart();
+			ioContext.run();
+
+			std::error_code fs_ec;
+			std::filesystem::remove(socketPath, fs_ec);
+		}
+
+		/// @brief	Runs the daemon until it receives SIGINT or SIGTERM.
+		void run()
+		{
+			boost::asio::signal_set signals{ ioContext, SIGINT, SIGTERM };
+			signals.async_wait([this](boost::system::error_code const& ec, int signal) {
+				if (ec) return;
+				ARRCON_LOG(LogLevel::Info) << "Received signal " << signal << "; stopping the daemon." << std::endl;
+				ioContext.stop();
+			});
+
+			boost::asio::co_spawn(ioContext, accept_loop(), boost::asio::detached);
+
+			ioContext.run();
+		}
+	};
+
+	/**
+	 * @brief				Sends commands to a target through the daemon listening on the specified socket.
+	 *\n					Each step must complete before its deadline, so a daemon that stops responding can't hang the caller; the first response
+	 *						 must arrive within the sum of the connect, authentication & command timeouts, and each later response within the command timeout.
+	 * @param socketPath  -	The location of the daemon's local socket.
+	 * @param target	  -	The target to send the commands to.
+	 * @param splitPrefix -	The words that are repeated before each part of a split Minecraft command.
+	 * @param timeouts	  -	The timeouts that the daemon uses for the target.
+	 * @param commands	  -	The commands to send.
+	 * @param onResponse  -	Callback that is invoked with the index of each command and its response, in order.
+	 * @returns				true when the commands were sent through the daemon; false when the daemon isn't running or the request couldn't be
+	 *						 written to it, in which case the daemon hasn't executed any of the commands, and they should be sent to the target directly.
+	 *\n					Once the request was written, the daemon may have executed the commands, so any failure after that point is thrown instead.
+	 */
+	inline bool send_via_daemon(std::filesystem::path const& socketPath, rcon::target_info const& target, std::string_view const splitPrefix, request_timeouts const& timeouts, std::vector<std::string> const& commands, std::function<void(size_t, std::string_view)> const& onResponse) noexcept(false)
+	{
+		io_context ioContext;
+		stream_protocol::socket socket{ ioContext };
+
+		// closes the socket when it expires, which makes the pending operation fail
+		boost::asio::steady_timer deadline{ ioContext };
+		bool timedOut{ false };
+		const auto set_deadline{ [&](int const timeout_ms) {
+			deadline.expires_after(std::chrono::milliseconds{ timeout_ms });
+			deadline.async_wait([&](boost::system::error_code const& ec) {
+				if (ec) return; //< the deadline was changed or cancelled
+				timedOut = true;
+				boost::system::error_code close_ec;
+				socket.close(close_ec);
+			});
+		} };
+
+		// build the request
+		std::string request;
+		append_frame(request, FrameType::Target, str::stringify(target.host, '\0', target.port, '\0', target.pass, '\0', target.responseEnd, '\0', target.dialect, '\0', splitPrefix, '\0',
+			timeouts.connect_timeout_ms, '\0', timeouts.connect_delay_ms, '\0', timeouts.auth_timeout_ms, '\0', timeouts.command_timeout_ms));
+		for (const auto& command : commands) {
+			append_frame(request, FrameType::Command, command);
+		}
+		append_frame(request, FrameType::End, {});
+
+		size_t completed{ 0 };
+		// the daemon doesn't execute a request until it has received all of it
+		bool written{ false };
+		std::string error;
+		std::exception_ptr failure;
+		boost::asio::co_spawn(ioContext, [&]() -> awaitable<void> {
+			set_deadline(timeouts.connect_timeout_ms);
+			co_await socket.async_connect(stream_protocol::endpoint{ socketPath.string() }, use_awaitable);
+
+			// the daemon may have to connect & authenticate before the first response
+			set_deadline(timeouts.connect_timeout_ms + timeouts.auth_timeout_ms + timeouts.command_timeout_ms);
+			co_await boost::asio::async_write(socket, boost::asio::buffer(request), use_awaitable);
+			written = true;
+
+			ARRCON_LOG(LogLevel::Debug) << "Sent " << commands.size() << " command" << (commands.size() == 1 ? "" : "s") << " through the daemon at " << socketPath << '.' << std::endl;
+
+			// receive the responses
+			std::string response;
+			while (completed < commands.size()) {
+				auto [type, body] { co_await async_read_frame(socket) };
+
+				switch (type) {
+				case FrameType::Data:
+					response.append(body);
+					break;
+				case FrameType::Done:
+					onResponse(completed++, response);
+					response.clear();
+					set_deadline(timeouts.command_timeout_ms);
+					break;
+				case FrameType::Error:
+					error = std::move(body);
+					co_return;
+				default:
+					throw make_exception("Received an unexpected frame of type '", static_cast<char>(type), "' from the daemon!");
+				}
+			}
+		}, [&](std::exception_ptr ex) {
+			failure = ex;
+			deadline.cancel();
+		});
+		ioContext.run();
+
+		if (!error.empty())
+			throw make_exception(error);
+		if (failure) {
+			try {
+				std::rethrow_exception(failure);
+			} catch (boost::system::system_error const& ex) {
+				if (!written) {
+					ARRCON_LOG(LogLevel::Debug) << "Couldn't send the commands to the daemon at " << socketPath << " due to error: " << (timedOut ? "Timed out" : ex.code().message()) << std::endl;
+					return false;
+				}
+				// sending the rest of the commands directly could execute them twice
+				if (timedOut)
+					throw make_exception("The daemon at ", socketPath, " didn't respond in time; ", commands.size() - completed, " of ", commands.size(), " commands didn't receive a response, and may or may not have been executed!");
+				throw make_exception("Lost the connection to the daemon at ", socketPath, " due to error: ", ex.code().message(), "; ", commands.size() - completed, " of ", commands.size(), " commands didn't receive a response, and may or may not have been executed!");
+			}
+		}
+		return true;
+	}
+#endif
+}
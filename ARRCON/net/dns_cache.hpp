@@ -0,0 +1,196 @@
+#pragma once
+#include "../logging.hpp"
+#include "../helpers/TempPath.hpp"
+
+// Boost::asio
+#include <boost/asio/ip/tcp.hpp>	//< for boost::asio::ip::tcp
+#include <boost/asio/ip/address.hpp>	//< for boost::asio::ip::make_address
+
+// STL
+#include <chrono>		//< for std::chrono
+#include <filesystem>	//< for std::filesystem
+#include <fstream>		//< for std::ifstream, std::ofstream
+#include <map>			//< for std::map
+#include <optional>		//< for std::optional
+#include <sstream>		//< for std::istringstream
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
+#include <vector>		//< for std::vector
+
+namespace net {
+	/**
+	 * @class	DnsCache
+	 * @brief	On-disk cache of resolved endpoints, which allows repeated invocations to skip DNS resolution.
+	 *\n		Each line of the cache file contains a hostname, port, expiry time (in seconds since the epoch),
+	 *			 resolved port number, and the addresses that the hostname resolved to, separated by spaces.
+	 *\n		Changes are saved once, when the cache is flushed or destroyed, rather than each time an entry changes.
+	 */
+	class DnsCache {
+		using tcp = boost::asio::ip::tcp;
+		using clock = std::chrono::system_clock;
+
+		struct entry {
+			std::vector<tcp::endpoint> endpoints;
+			int64_t expiry;
+		};
+
+		std::filesystem::path path;
+		std::chrono::seconds ttl;
+		/// @brief	Cached entries, keyed by "host port".
+		std::map<std::string, entry> entries;
+		/// @brief	Whether the entries were changed since they were loaded or saved.
+		bool dirty{ false };
+
+		static std::string make_key(std::string_view host, std::string_view port)
+		{
+			return std::string{ host }.append(1, ' ').append(port);
+		}
+		static int64_t now()
+		{
+			return std::chrono::duration_cast<std::chrono::seconds>(clock::now().time_since_epoch()).count();
+		}
+
+		/// @brief	Loads the unexpired entries from the cache file.
+		void load()
+		{
+			std::ifstream ifs{ path };
+			if (!ifs) return;
+
+			const auto currentTime{ now() };
+
+			for (std::string line; std::getline(ifs, line);) {
+				std::istringstream iss{ line };
+
+				std::string host, port;
+				int64_t expiry{};
+				unsigned short portNumber{};
+				if (!(iss >> host >> port >> expiry >> portNumber) || expiry <= currentTime)
+					continue;
+
+				entry e{ {}, expiry };
+				for (std::string address; iss >> address;) {
+					boost::system::error_code ec;
+					const auto addr{ boost::asio::ip::make_address(address, ec) };
+					if (ec) break;
+					e.endpoints.emplace_back(addr, portNumber);
+				}
+				if (!e.endpoints.empty())
+					entries.insert_or_assign(make_key(host, port), std::move(e));
+			}
+
+			ARRCON_LOG(LogLevel::Trace) << "Loaded " << entries.size() << " DNS cache entr" << (entries.size() == 1 ? "y" : "ies") << " from " << path << std::endl;
+		}
+
+		/// @brief	Writes the unexpired entries to the cache file, replacing it atomically.
+		void save() const
+		{
+			const auto currentTime{ now() };
+			const auto tmpPath{ make_temp_path(path) };
+
+			std::error_code fs_ec;
+			std::filesystem::create_directories(path.parent_path(), fs_ec);
+			{
+				std::ofstream ofs{ tmpPath, std::ios::trunc };
+				if (!ofs) {
+					ARRCON_LOG(LogLevel::Warning) << "Failed to write the DNS cache to " << tmpPath << std::endl;
+					return;
+				}
+
+				for (const auto& [key, e] : entries) {
+					if (e.expiry <= currentTime) continue;
+
+					ofs << key << ' ' << e.expiry << ' ' << e.endpoints.front().port();
+					for (const auto& endpoint : e.endpoints) {
+						ofs << ' ' << endpoint.address().to_string();
+					}
+					ofs << '\n';
+				}
+			}
+
+			std::filesystem::rename(tmpPath, path, fs_ec);
+			if (fs_ec) {
+				ARRCON_LOG(LogLevel::Warning) << "Failed to save the DNS cache to " << path << " due to error: " << fs_ec.message() << std::endl;
+				std::filesystem::remove(tmpPath, fs_ec);
+			}
+		}
+
+	public:
+		/// @brief	The default number of seconds that resolved endpoints are cached for.
+		static constexpr int64_t DEFAULT_TTL{ 300 };
+
+		/**
+		 * @brief			Creates a new DnsCache instance, and loads the cache file if it exists.
+		 * @param path	  -	The location of the cache file.
+		 * @param ttl	  -	The amount of time that newly resolved endpoints are cached for.
+		 */
+		DnsCache(std::filesystem::path const& path, std::chrono::seconds const ttl = std::chrono::seconds{ DEFAULT_TTL }) : path{ path }, ttl{ ttl }
+		{
+			load();
+		}
+		DnsCache(DnsCache const&) = delete;
+		DnsCache& operator=(DnsCache const&) = delete;
+		/// @brief	Saves the cache file if it was changed.
+		~DnsCache()
+		{
+			flush();
+		}
+
+		/// @brief	Saves the cache file if the entries were changed since it was loaded or last saved.
+		void flush()
+		{
+			if (!dirty) return;
+			save();
+			dirty = false;
+		}
+
+		/**
+		 * @brief			Checks whether the specified host should be cached. IP addresses don't need to be resolved, so they aren't cached.
+		 * @param host	  -	The target hostname or IP address.
+		 * @returns			True when the host is a hostname; otherwise, false.
+		 */
+		static bool is_cacheable(std::string_view host)
+		{
+			boost::system::error_code ec;
+			boost::asio::ip::make_address(host, ec);
+			return ec.failed();
+		}
+
+		/**
+		 * @brief			Gets the cached endpoints for the specified host and port.
+		 * @param host	  -	The target hostname.
+		 * @param port	  -	The target port.
+		 * @returns			The cached endpoints if they exist and haven't expired; otherwise, std::nullopt.
+		 */
+		std::optional<std::vector<tcp::endpoint>> get(std::string_view host, std::string_view port) const
+		{
+			if (const auto it{ entries.find(make_key(host, port)) }; it != entries.end() && it->second.expiry > now())
+				return it->second.endpoints;
+			return std::nullopt;
+		}
+
+		/**
+		 * @brief				Caches the resolved endpoints for the specified host and port.
+		 * @param host		  -	The target hostname.
+		 * @param port		  -	The target port.
+		 * @param endpoints	  -	The endpoints that the target resolved to.
+		 */
+		void put(std::string_view host, std::string_view port, std::vector<tcp::endpoint> const& endpoints)
+		{
+			if (ttl.count() <= 0 || endpoints.empty() || !is_cacheable(host)) return;
+
+			entries.insert_or_assign(make_key(host, port), entry{ endpoints, now() + ttl.count() });
+			dirty = true;
+		}
+
+		/**
+		 * @brief			Removes the cached endpoints for the specified host and port.
+		 * @param host	  -	The target hostname.
+		 * @param port	  -	The target port.
+		 */
+		void erase(std::string_view host, std::string_view port)
+		{
+			if (entries.erase(make_key(host, port)) > 0)
+				dirty = true;
+		}
+	};
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "rcon.hpp"
+#include "target_info.hpp"
+
+// Boost::asio
+#include <boost/asio/detached.hpp>	//< for boost::asio::detached
+
+// STL
+#include <string>		//< for std::string
+#include <vector>		//< for std::vector
+#include <functional>	//< for std::function
+#include <exception>	//< for std::exception_ptr
+#include <optional>		//< for std::optional
+
+namespace net::rcon {
+	/// @brief	A target paired with the name it was saved as in the hosts file.
+	using named_target = std::pair<std::string, target_info>;
+
+	struct fanout_settings {
+		/// @brief	The maximum number of targets to communicate with at once.
+		size_t concurrency{ 16 };
+		/// @brief	The maximum number of commands that may await a response from each target at once.
+		size_t pipelineDepth{ 1 };
+		/// @brief	The number of milliseconds that DNS resolution & connecting to each target may take.
+		int connect_timeout_ms{ 3000 };
+		/// @brief	The number of milliseconds to wait before trying the next resolved address of a target.
+		int connect_delay_ms{ 250 };
+		/// @brief	The number of milliseconds that authenticating with each target may take.
+		int auth_timeout_ms{ 3000 };
+		/// @brief	The number of milliseconds to wait for the complete response to each command.
+		int command_timeout_ms{ 3000 };
+		/// @brief	Optional limit on the rate that commands are sent to each target, or std::nullopt to send them as soon as possible.
+		std::optional<rate_limit> rateLimit;
+		/// @brief	The words that are repeated before each part of a split Minecraft command, or empty to never split them.
+		std::string splitPrefix;
+		/// @brief	Optional cache of resolved endpoints, or nullptr to always resolve targets.
+		DnsCache* dnsCache{ nullptr };
+		/// @brief	Optional statistics that the statistics of every target are merged into, or nullptr.
+		client_stats* stats{ nullptr };
+	};
+
+	/**
+	 * @brief				Connects to, authenticates with, and sends the same commands to each of the specified targets concurrently.
+	 *\n					All targets are driven by a single io_context on the calling thread; callbacks are invoked on the calling thread.
+	 * @param targets	  -	The targets to send the commands to.
+	 * @param commands	  -	The commands to send to each target.
+	 * @param settings	  -	The settings to use.
+	 * @param onResponse  -	Callback that is invoked with the target index, command index, response, and response details of each command.
+	 *						Responses from each target are received in submission order.
+	 * @param onComplete  -	Callback that is invoked with the target index and the exception that caused it to fail (or nullptr) when a target is finished.
+	 * @returns				The number of targets that failed.
+	 */
+	inline size_t fanout(std::vector<named_target> const& targets,
+						 std::vector<std::string> const& commands,
+						 fanout_settings const& settings,
+						 std::function<void(size_t, size_t, std::string&&, response_info const&)> const& onResponse,
+						 std::function<void(size_t, std::exception_ptr)> const& onComplete)
+	{
+		io_context ioContext;
+		size_t next{ 0 }, failed{ 0 };
+
+		// each worker handles one target at a time until there are none left
+		const auto worker{ [&]() -> awaitable<void> {
+			while (next < targets.size()) {
+				const size_t index{ next++ };
+				const auto& [name, target] { targets[index] };
+
+				std::exception_ptr error;
+				RconClient client{ ioContext };
+				std::optional<rate_limiter> limiter;
+				if (settings.rateLimit.has_value())
+					limiter.emplace(*settings.rateLimit);
+				try {
+					client.set_connect_timeout(settings.connect_timeout_ms);
+					client.set_connect_attempt_delay(settings.connect_delay_ms);
+					client.set_auth_timeout(settings.auth_timeout_ms);
+					client.set_command_timeout(settings.command_timeout_ms);
+					client.set_response_end(target.responseEnd);
+					client.set_dialect(target.dialect);
+					client.set_split_prefix(settings.splitPrefix);
+					client.set_dns_cache(settings.dnsCache);
+					client.set_rate_limiter(limiter ? &*limiter : nullptr);
+
+					co_await client.async_connect(target.host, target.port);
+
+					const bool authenticated{ co_await client.async_authenticate(target.pass) };
+					if (!authenticated)
+						throw make_exception("Authentication Error:  Incorrect Password!");
+
+					ARRCON_LOG(LogLevel::Debug) << '[' << name << ']' << " Authenticated with " << target << std::endl;
+
+					co_await client.async_command_pipelined(commands, settings.pipelineDepth, [&, index](size_t commandIndex, std::string&& response, response_info const& info) {
+						onResponse(index, commandIndex, std::move(response), info);
+					});
+				} catch (std::exception const& ex) {
+					ARRCON_LOG(LogLevel::Error) << '[' << name << ']' << ' ' << ex.what() << std::endl;
+					error = std::current_exception();
+					++failed;
+				}
+
+				if (settings.stats)
+					settings.stats->merge(client.get_stats());
+
+				onComplete(index, error);
+			}
+		} };
+
+		const size_t workerCount{ std::min(std::max(settings.concurrency, size_t{ 1 }), targets.size()) };
+		for (size_t i{ 0 }; i < workerCount; ++i) {
+			boost::asio::co_spawn(ioContext, worker(), boost::asio::detached);
+		}
+
+		ARRCON_LOG(LogLevel::Debug) << "Sending " << commands.size() << " command" << (commands.size() == 1 ? "" : "s") << " to " << targets.size() << " target" << (targets.size() == 1 ? "" : "s") << " using " << workerCount << " concurrent connection" << (workerCount == 1 ? "" : "s") << '.' << std::endl;
+
+		ioContext.run();
+
+		return failed;
+	}
+}
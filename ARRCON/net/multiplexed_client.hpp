@@ -0,0 +1,305 @@
+#pragma once
+#include "rcon.hpp"
+
+// Boost::asio
+#include <boost/asio/executor_work_guard.hpp>	//< for boost::asio::executor_work_guard
+#include <boost/asio/post.hpp>					//< for boost::asio::post
+#include <boost/asio/steady_timer.hpp>			//< for boost::asio::steady_timer
+
+// STL
+#include <chrono>			//< for std::chrono
+#include <deque>			//< for std::deque
+#include <exception>		//< for std::exception_ptr
+#include <functional>		//< for std::function
+#include <future>			//< for std::future, std::promise
+#include <memory>			//< for std::shared_ptr
+#include <string>			//< for std::string
+#include <thread>			//< for std::thread
+#include <unordered_map>	//< for std::unordered_map
+
+namespace net::rcon {
+	/// @brief	Callback that receives the outcome of a command; the error is nullptr when the response was received successfully.
+	using completion_handler = std::function<void(std::exception_ptr, std::string&&, response_info const&)>;
+
+	/**
+	 * @class	MultiplexedClient
+	 * @brief	RCON client that many threads can submit commands to at once, over a single connection.
+	 *\n		The connection is driven by an RconClient on the multiplexed client's own I/O thread. Submitted commands are posted to
+	 *			 that thread and sent as soon as possible, so commands from different threads are pipelined rather than serialized.
+	 *\n		Responses are routed to their command through a table of packet IDs, and passed to its completion handler or future.
+	 *			 Commands always use message terminators to find the end of their response, regardless of the response end strategy.
+	 */
+	class MultiplexedClient {
+		using clock = std::chrono::steady_clock;
+
+		struct pending_command {
+			std::string command;
+			completion_handler onComplete;
+			int32_t packetId{ 0 };
+			int32_t termPacketId{ 0 };
+			clock::time_point sentAt{};
+			clock::time_point expiry{};
+			std::string response;
+			response_info info{};
+			bool complete{ false };
+		};
+
+		io_context ioContext;
+		boost::asio::executor_work_guard<io_context::executor_type> work{ boost::asio::make_work_guard(ioContext) };
+		RconClient client{ ioContext };
+
+		// everything below is only accessed from the I/O thread
+
+		/// @brief	Submitted commands that haven't been sent yet, in submission order.
+		std::deque<std::shared_ptr<pending_command>> sendQueue;
+		/// @brief	Sent commands that haven't been completed yet, in the order they were sent.
+		std::deque<std::shared_ptr<pending_command>> inFlight;
+		/// @brief	Maps the packet IDs of each sent command & its terminator to the command.
+		std::unordered_map<int32_t, std::shared_ptr<pending_command>> packetIdMap;
+		/// @brief	Wakes the sender when a command is submitted.
+		boost::asio::steady_timer sendWakeup{ ioContext, clock::time_point::max() };
+		/// @brief	Expires when the oldest in-flight command times out.
+		boost::asio::steady_timer watchdog{ ioContext, clock::time_point::max() };
+		bool running{ false };
+		/// @brief	Why the connection was closed, which is passed to commands that are submitted afterwards.
+		std::exception_ptr closedReason;
+
+		std::thread ioThread{ [this] { ioContext.run(); } };
+
+		/// @brief	Passes the outcome of a command to its completion handler, which may not throw.
+		static void complete(pending_command& cmd, std::exception_ptr error)
+		{
+			cmd.complete = true;
+			try {
+				cmd.onComplete(error, std::move(cmd.response), cmd.info);
+			} catch (std::exception const& ex) {
+				ARRCON_LOG(LogLevel::Error) << "The completion handler of command \"" << cmd.command << "\" threw an exception: " << ex.what() << std::endl;
+			} catch (...) {
+				ARRCON_LOG(LogLevel::Error) << "The completion handler of command \"" << cmd.command << "\" threw an exception." << std::endl;
+			}
+		}
+
+		/// @brief	Fails every command that hasn't completed yet, closes the connection, and stops the coroutines that drive it.
+		void close(std::exception_ptr reason)
+		{
+			if (!closedReason)
+				closedReason = reason;
+			running = false;
+
+			for (auto& cmd : inFlight) {
+				if (!cmd->complete)
+					complete(*cmd, closedReason);
+			}
+			for (auto& cmd : sendQueue) {
+				complete(*cmd, closedReason);
+			}
+			inFlight.clear();
+			sendQueue.clear();
+			packetIdMap.clear();
+
+			boost::system::error_code ec;
+			client.socket.close(ec);
+			sendWakeup.cancel();
+			watchdog.cancel();
+		}
+
+		/// @brief	Queues a submitted command to be sent. Runs on the I/O thread.
+		void enqueue(std::shared_ptr<pending_command> cmd)
+		{
+			if (!running) {
+				complete(*cmd, closedReason ? closedReason : std::make_exception_ptr(make_exception("The client isn't connected!")));
+				return;
+			}
+			sendQueue.emplace_back(std::move(cmd));
+			if (sendQueue.size() == 1)
+				sendWakeup.cancel();
+		}
+
+		/// @brief	Sends queued commands as they are submitted.
+		awaitable<void> async_send_loop()
+		{
+			try {
+				while (running) {
+					if (sendQueue.empty()) {
+						boost::system::error_code ec;
+						sendWakeup.expires_at(clock::time_point::max());
+						co_await sendWakeup.async_wait(boost::asio::redirect_error(use_awaitable, ec));
+						continue;
+					}
+
+					if (client.rateLimiter != nullptr) {
+						co_await client.async_wait_for_rate_limit();
+						if (!running)
+							break;
+						client.rateLimiter->take();
+					}
+
+					auto cmd{ std::move(sendQueue.front()) };
+					sendQueue.pop_front();
+
+					// register the packet IDs before sending, so that the receiver can't see a response before its command is known
+					cmd->packetId = client.get_next_packet_id();
+					cmd->termPacketId = client.get_next_packet_id();
+					cmd->sentAt = clock::now();
+					cmd->expiry = cmd->sentAt + client.commandTimeout;
+					packetIdMap[cmd->packetId] = cmd;
+					packetIdMap[cmd->termPacketId] = cmd;
+					inFlight.emplace_back(cmd);
+					if (inFlight.size() == 1)
+						watchdog.cancel();
+
+					co_await client.async_send_command(cmd->command, cmd->packetId, cmd->termPacketId, true);
+				}
+			} catch (...) {
+				close(std::current_exception());
+			}
+		}
+
+		/// @brief	Receives packets and routes them to the command they belong to.
+		awaitable<void> async_receive_loop()
+		{
+			try {
+				while (running) {
+					const auto packet{ co_await client.async_recv() };
+
+					const auto it{ packetIdMap.find(packet.header.id) };
+					if (it == packetIdMap.end()) {
+						ARRCON_LOG(LogLevel::Trace) << "Discarded unexpected packet with ID " << packet.header.id << '.' << std::endl;
+						continue;
+					}
+
+					const auto cmd{ it->second };
+					const auto elapsed{ clock::now() - cmd->sentAt };
+					if (cmd->info.packets == 0) {
+						cmd->info.firstByte = elapsed;
+						client.stats.record(Phase::FirstByte, elapsed);
+					}
+
+					if (packet.header.id == cmd->packetId) {
+						cmd->response.append(packet.body);
+						++cmd->info.packets;
+						continue;
+					}
+
+					// received the terminator for this command
+					cmd->info.lastByte = elapsed;
+					client.stats.record(Phase::LastByte, elapsed);
+					++client.stats.commands;
+					if (client.rateLimiter != nullptr)
+						client.rateLimiter->observe(elapsed);
+					packetIdMap.erase(cmd->packetId);
+					packetIdMap.erase(cmd->termPacketId);
+
+					ARRCON_LOG(LogLevel::Debug) << "Received " << cmd->info.packets << " response packet" << (cmd->info.packets == 1 ? "" : "s") << " for packet #" << cmd->packetId << '.' << std::endl;
+
+					complete(*cmd, nullptr);
+					while (!inFlight.empty() && inFlight.front()->complete) {
+						inFlight.pop_front();
+					}
+				}
+			} catch (...) {
+				if (running)
+					close(std::current_exception());
+			}
+		}
+
+		/// @brief	Fails commands that don't receive their complete response before the command timeout. Other commands are unaffected.
+		awaitable<void> async_watchdog_loop()
+		{
+			while (running) {
+				while (!inFlight.empty() && inFlight.front()->complete) {
+					inFlight.pop_front();
+				}
+
+				boost::system::error_code ec;
+				watchdog.expires_at(inFlight.empty() ? clock::time_point::max() : inFlight.front()->expiry);
+				co_await watchdog.async_wait(boost::asio::redirect_error(use_awaitable, ec));
+
+				// commands are sent in order & have the same timeout, so the oldest command always expires first
+				for (const auto now{ clock::now() }; running && !inFlight.empty() && inFlight.front()->expiry <= now; inFlight.pop_front()) {
+					auto& cmd{ *inFlight.front() };
+					if (cmd.complete)
+						continue;
+
+					// the response may still arrive, but it is discarded
+					packetIdMap.erase(cmd.packetId);
+					packetIdMap.erase(cmd.termPacketId);
+					complete(cmd, std::make_exception_ptr(make_exception("Timed out after ", client.commandTimeout.count(), "ms while waiting for a response to \"", cmd.command, "\"!")));
+				}
+			}
+		}
+
+		/// @brief	Connects & authenticates, then starts driving the connection.
+		awaitable<void> async_open(std::string host, std::string port, std::string password) noexcept(false)
+		{
+			co_await client.async_connect(host, port);
+			const bool authenticated{ co_await client.async_authenticate(password) };
+			if (!authenticated)
+				throw make_exception("Authentication Error:  Incorrect Password!");
+
+			running = true;
+			closedReason = nullptr;
+			boost::asio::co_spawn(ioContext, async_send_loop(), boost::asio::detached);
+			boost::asio::co_spawn(ioContext, async_receive_loop(), boost::asio::detached);
+			boost::asio::co_spawn(ioContext, async_watchdog_loop(), boost::asio::detached);
+		}
+
+	public:
+		/// @brief	Creates a new MultiplexedClient, and starts its I/O thread.
+		MultiplexedClient() = default;
+		MultiplexedClient(MultiplexedClient const&) = delete;
+		MultiplexedClient& operator=(MultiplexedClient const&) = delete;
+		/// @brief	Fails every command that hasn't completed yet, then closes the connection and stops the I/O thread.
+		~MultiplexedClient()
+		{
+			boost::asio::post(ioContext, [this] { close(std::make_exception_ptr(make_exception("The client was destroyed!"))); });
+			work.reset();
+			ioThread.join();
+		}
+
+		/**
+		 * @brief	Gets the underlying client, so that its settings (timeouts, dialect, rate limiter, DNS cache) can be changed.
+		 *\n		The client may only be accessed before connect() is called.
+		 */
+		RconClient& get_client() noexcept { return client; }
+
+		/**
+		 * @brief				Connects to the specified server and authenticates, blocking until both have completed.
+		 * @param host		  -	The target hostname or IP.
+		 * @param port		  -	The target port.
+		 * @param password	  -	The password to send to the server.
+		 */
+		void connect(std::string host, std::string port, std::string password) noexcept(false)
+		{
+			boost::asio::co_spawn(ioContext, async_open(std::move(host), std::move(port), std::move(password)), boost::asio::use_future).get();
+		}
+
+		/**
+		 * @brief				Submits a command to be sent to the server. May be called from any thread.
+		 * @param command	  -	The command to send to the server.
+		 * @param onComplete  -	Callback that receives the response, or the error that prevented it from being received.
+		 *						 It is called on the I/O thread, so it should return quickly and must not wait for other commands.
+		 */
+		void command(std::string command, completion_handler onComplete)
+		{
+			auto cmd{ std::make_shared<pending_command>(std::move(command), std::move(onComplete)) };
+			boost::asio::post(ioContext, [this, cmd = std::move(cmd)]() mutable { enqueue(std::move(cmd)); });
+		}
+		/**
+		 * @brief				Submits a command to be sent to the server. May be called from any thread.
+		 * @param command	  -	The command to send to the server.
+		 * @returns				A future that receives the response, or the error that prevented it from being received.
+		 */
+		std::future<std::string> command(std::string command)
+		{
+			const auto promise{ std::make_shared<std::promise<std::string>>() };
+			auto future{ promise->get_future() };
+			this->command(std::move(command), [promise](std::exception_ptr error, std::string&& response, response_info const&) {
+				if (error)
+					promise->set_exception(error);
+				else promise->set_value(std::move(response));
+			});
+			return future;
+		}
+	};
+}
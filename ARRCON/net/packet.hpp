@@ -0,0 +1,53 @@
+#pragma once
+// STL
+#include <cstdint>	//< for sized integer types
+#include <cstring>	//< for std::memcpy
+#include <limits>	//< for std::numeric_limits
+#include <array>	//< for std::array
+#include <vector>	//< for std::vector
+#include <string>	//< for std::string
+
+namespace net::rcon {
+	enum class PacketType : int32_t {
+		SERVERDATA_AUTH = 3,
+		SERVERDATA_AUTH_RESPONSE = 2,
+		SERVERDATA_EXECCOMMAND = 2,
+		SERVERDATA_RESPONSE_VALUE = 0,
+	};
+
+	inline constexpr const int32_t PACKETID_MIN{ 1 };
+	inline constexpr const int32_t PACKETID_MAX{ std::numeric_limits<int32_t>::max() };
+
+	struct packet_header {
+		int32_t size{};
+		int32_t id{};
+		int32_t type{};
+	};
+
+	inline constexpr int32_t get_packet_size(size_t const bodySize)
+	{
+		// 4 packet size bytes aren't included vvvvvvv
+		return (sizeof(packet_header) - sizeof(int32_t)) + bodySize + 2;
+	}
+
+	/// @brief	Minimum possible size of an RCON packet.
+	inline constexpr const int32_t PACKETSZ_MIN{ sizeof(packet_header) + 2 };
+	/// @brief	Maximum number of bytes that can be sent in a single packet, before being split between multiple packets.
+	inline constexpr const int32_t PACKETSZ_MAX_SEND{ 4096 };
+	/// @brief	The null bytes that terminate every packet body.
+	inline constexpr const std::array<uint8_t, 2> PACKET_TERMINATOR{ 0, 0 };
+
+	/**
+	 * @brief			Converts the specified vector of bytes to a string by direct copying.
+	 * @param bytes	  -	A vector of bytes to convert to a readable string.
+	 * @returns			The string representation of the specified bytes.
+	 */
+	inline std::string bytes_to_string(std::vector<uint8_t> const& bytes)
+	{
+		std::string s{ bytes.size(), 0, std::allocator<char>() };
+
+		std::memcpy(const_cast<char*>(s.c_str()), bytes.data(), bytes.size());
+
+		return s;
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include "packet.hpp"
+
+// 307lib::shared
+#include <make_exception.hpp>	//< for make_exception
+
+// Boost::asio
+#include <boost/asio/buffer.hpp>	//< for boost::asio::mutable_buffer
+
+// STL
+#include <algorithm>	//< for std::max
+#include <cstring>		//< for std::memcpy, std::memmove
+#include <optional>		//< for std::optional
+#include <string_view>	//< for std::string_view
+#include <vector>		//< for std::vector
+
+namespace net::rcon {
+	/// @brief	A received packet. The body is a view into the packet_reader's buffer, which is only valid until more data is received.
+	struct packet_view {
+		packet_header header;
+		std::string_view body;
+	};
+
+	/**
+	 * @class	packet_reader
+	 * @brief	Buffers raw bytes received from a socket and parses complete packets out of them in place.
+	 *\n		Each read fills as much of the buffer as the socket has available, so multi-packet responses
+	 *			 are usually parsed from a single read. Unparsed bytes are only moved back to the start of
+	 *			 the buffer when there isn't enough free space left for the next read.
+	 */
+	class packet_reader {
+		std::vector<char> buf;
+		/// @brief	Index of the first unparsed byte.
+		size_t readPos{ 0 };
+		/// @brief	Index one past the last received byte.
+		size_t writePos{ 0 };
+
+		/// @brief	Gets the total size of the packet at the read position, including the size field. Requires at least 4 unparsed bytes.
+		size_t peek_packet_size() const noexcept
+		{
+			int32_t size;
+			std::memcpy(&size, buf.data() + readPos, sizeof(int32_t));
+			return sizeof(int32_t) + static_cast<size_t>(std::max(size, 0));
+		}
+
+	public:
+		/// @brief	The initial size of the buffer, which fits several maximum-size response packets.
+		static constexpr size_t DEFAULT_CAPACITY{ 64 * 1024 };
+		/// @brief	The minimum amount of free space to make available for each read.
+		static constexpr size_t MIN_READ_SIZE{ 4096 };
+		/// @brief	The largest packet size that will be accepted before assuming the stream is corrupt.
+		static constexpr int32_t PACKETSZ_MAX_RECV{ 16 * 1024 * 1024 };
+
+		packet_reader() : buf(DEFAULT_CAPACITY) {}
+
+		/// @brief	Gets the number of received bytes that haven't been parsed yet.
+		size_t size() const noexcept { return writePos - readPos; }
+
+		/**
+		 * @brief	Gets the free space at the end of the buffer to read into, making room for at least the rest of the pending packet.
+		 *\n		This invalidates the bodies of previously parsed packets.
+		 * @returns	The writable region of the buffer.
+		 */
+		boost::asio::mutable_buffer prepare()
+		{
+			size_t required{ MIN_READ_SIZE };
+			if (size() >= sizeof(int32_t)) {
+				// make sure that the rest of the pending packet fits
+				if (const auto packetSize{ peek_packet_size() }; packetSize > size())
+					required = std::max(required, packetSize - size());
+			}
+
+			if (buf.size() - writePos < required) {
+				// move the unparsed bytes to the start of the buffer
+				if (readPos > 0) {
+					std::memmove(buf.data(), buf.data() + readPos, size());
+					writePos -= readPos;
+					readPos = 0;
+				}
+				// grow the buffer if there still isn't enough room
+				if (buf.size() - writePos < required)
+					buf.resize(writePos + required);
+			}
+
+			return boost::asio::buffer(buf.data() + writePos, buf.size() - writePos);
+		}
+		/**
+		 * @brief			Marks bytes that were written into the region returned by prepare() as received.
+		 * @param count	  -	The number of bytes that were received.
+		 */
+		void commit(size_t const count) noexcept
+		{
+			writePos += count;
+		}
+
+		/**
+		 * @brief	Parses the next complete packet from the buffer.
+		 * @returns	The packet when a complete packet has been received; otherwise, std::nullopt.
+		 */
+		std::optional<packet_view> parse_next() noexcept(false)
+		{
+			if (size() < sizeof(packet_header))
+				return std::nullopt;
+
+			packet_header header;
+			std::memcpy(&header, buf.data() + readPos, sizeof(packet_header));
+
+			if (header.size + static_cast<int32_t>(sizeof(int32_t)) < PACKETSZ_MIN || header.size > PACKETSZ_MAX_RECV)
+				throw make_exception("Received a packet with an invalid size of ", header.size, " bytes!");
+
+			const size_t packetSize{ sizeof(int32_t) + static_cast<size_t>(header.size) };
+			if (size() < packetSize)
+				return std::nullopt;
+
+			std::string_view body{ buf.data() + readPos + sizeof(packet_header), packetSize - sizeof(packet_header) };
+			// remove the null terminators from the body
+			while (!body.empty() && body.back() == '\0')
+				body.remove_suffix(1);
+
+			readPos += packetSize;
+			if (readPos == writePos) // the buffer is empty; start over from the beginning without moving anything
+				readPos = writePos = 0;
+
+			return packet_view{ header, body };
+		}
+
+		/**
+		 * @brief	Removes all of the unparsed bytes from the buffer and returns them.
+		 * @returns	The unparsed bytes.
+		 */
+		std::vector<uint8_t> take()
+		{
+			std::vector<uint8_t> bytes(buf.data() + readPos, buf.data() + writePos);
+			readPos = writePos = 0;
+			return bytes;
+		}
+	};
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include "../logging.hpp"
+
+// STL
+#include <algorithm>	//< for std::min, std::max
+#include <charconv>		//< for std::from_chars
+#include <chrono>		//< for std::chrono
+#include <cmath>		//< for std::isfinite
+#include <optional>		//< for std::optional
+#include <ostream>		//< for std::ostream
+#include <string_view>	//< for std::string_view
+
+namespace net::rcon {
+	/**
+	 * @struct	rate_limit
+	 * @brief	The rate that commands may be sent at. The string form is "<cmds/sec>[:<burst>]", e.g. "20" or "50:10".
+	 */
+	struct rate_limit {
+		/// @brief	The number of commands that may be sent per second, on average.
+		double rate{ 0 };
+		/// @brief	The number of commands that may be sent at once after a pause. Defaults to 1, which spaces every command evenly.
+		double burst{ 1 };
+		/// @brief	When true, the rate is lowered while response latency is elevated, and raised back towards the limit when it recovers.
+		bool adaptive{ false };
+
+		/**
+		 * @brief			Parses a rate limit from its string form.
+		 * @param text	  -	The string to parse.
+		 * @returns			The rate limit when successful; otherwise, std::nullopt.
+		 */
+		static std::optional<rate_limit> parse(std::string_view text)
+		{
+			const auto parse_number{ [](std::string_view s) -> std::optional<double> {
+				double value{};
+				const auto [ptr, ec] { std::from_chars(s.data(), s.data() + s.size(), value) };
+				if (ec != std::errc{} || ptr != s.data() + s.size() || !std::isfinite(value) || value <= 0)
+					return std::nullopt;
+				return value;
+			} };
+
+			rate_limit limit;
+
+			const auto sep{ text.find(':') };
+			if (const auto rate{ parse_number(text.substr(0, sep)) }; rate.has_value())
+				limit.rate = *rate;
+			else return std::nullopt;
+
+			if (sep != std::string_view::npos) {
+				if (const auto burst{ parse_number(text.substr(sep + 1)) }; burst.has_value() && *burst >= 1)
+					limit.burst = *burst;
+				else return std::nullopt;
+			}
+
+			return limit;
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const rate_limit& l)
+		{
+			os << l.rate << ':' << l.burst;
+			if (l.adaptive)
+				os << " (adaptive)";
+			return os;
+		}
+	};
+
+	/**
+	 * @class	rate_limiter
+	 * @brief	Token bucket that schedules when commands may be sent.
+	 *\n		The bucket holds up to burst tokens and refills at the current rate; each command takes one token.
+	 *			 Unlike a fixed delay between commands, the time spent waiting for a response counts towards the next command.
+	 *\n		When adaptive, the current rate is lowered multiplicatively whenever the smoothed response latency rises well above
+	 *			 the lowest recent latency, and raised additively back towards the limit while it stays close to it.
+	 *			 Responses to commands that were sent before the rate was last lowered are ignored, since they were queued at the old rate.
+	 */
+	class rate_limiter {
+		using clock = std::chrono::steady_clock;
+		using seconds = std::chrono::duration<double>;
+
+		/// @brief	The smoothed latency must exceed the baseline latency by this factor before the rate is lowered.
+		static constexpr double LATENCY_TOLERANCE{ 2.0 };
+		/// @brief	The smoothed latency must also exceed the baseline latency by this much, so that jitter on very fast connections is ignored.
+		static constexpr seconds LATENCY_SLACK{ 0.002 };
+		/// @brief	The factor that the rate is multiplied by when latency is elevated.
+		static constexpr double DECREASE_FACTOR{ 0.7 };
+		/// @brief	The fraction of the limit that the rate is raised by for each response with normal latency.
+		static constexpr double INCREASE_STEP{ 0.02 };
+		/// @brief	The lowest fraction of the limit that the rate may be lowered to.
+		static constexpr double MIN_RATE_FACTOR{ 0.01 };
+
+		rate_limit limit;
+		/// @brief	The current rate, which is only lower than the limit when adaptive.
+		double rate;
+		double tokens;
+		clock::time_point lastRefill;
+
+		/// @brief	The lowest recent latency, which slowly rises towards higher samples so that a lasting change is eventually accepted.
+		seconds baselineLatency{ 0 };
+		/// @brief	The exponentially-weighted moving average of the latency.
+		seconds smoothedLatency{ 0 };
+		/// @brief	The last time that the rate was lowered.
+		clock::time_point decreasedAt{};
+
+		void refill(clock::time_point const now)
+		{
+			if (now > lastRefill) {
+				tokens = std::min(limit.burst, tokens + seconds{ now - lastRefill }.count() * rate);
+				lastRefill = now;
+			}
+		}
+
+	public:
+		rate_limiter(rate_limit const& limit) : limit{ limit }, rate{ limit.rate }, tokens{ limit.burst }, lastRefill{ clock::now() } {}
+
+		/// @brief	Gets the rate that commands are currently being sent at.
+		double current_rate() const noexcept { return rate; }
+
+		/**
+		 * @brief			Gets how long to wait until a command may be sent.
+		 * @param now	  -	The current time.
+		 * @returns			Zero when a token is available; otherwise, the time until one will be.
+		 */
+		clock::duration ready_in(clock::time_point const now = clock::now())
+		{
+			refill(now);
+			if (tokens >= 1.0)
+				return clock::duration::zero();
+			return std::chrono::ceil<clock::duration>(seconds{ (1.0 - tokens) / rate });
+		}
+		/**
+		 * @brief			Takes a token for a command that is being sent. Should only be called when ready_in() returned zero.
+		 * @param now	  -	The current time.
+		 */
+		void take(clock::time_point const now = clock::now())
+		{
+			refill(now);
+			tokens -= 1.0;
+		}
+
+		/**
+		 * @brief			Adjusts the current rate according to the latency of a response, when adaptive.
+		 * @param latency -	The time between sending a command and receiving its complete response.
+		 */
+		void observe(clock::duration const latency)
+		{
+			if (!limit.adaptive)
+				return;
+
+			const seconds sample{ latency };
+			const auto now{ clock::now() };
+
+			if (baselineLatency == seconds::zero() || sample < baselineLatency)
+				baselineLatency = sample;
+			else baselineLatency += (sample - baselineLatency) / 256;
+
+			if (now - latency < decreasedAt)
+				return; //< sent before the rate was lowered
+			if (smoothedLatency == seconds::zero()) {
+				smoothedLatency = sample;
+				return;
+			}
+			smoothedLatency += (sample - smoothedLatency) / 8;
+
+			refill(now); //< tokens accumulated so far were earned at the previous rate
+
+			if (smoothedLatency > baselineLatency * LATENCY_TOLERANCE && smoothedLatency > baselineLatency + LATENCY_SLACK) {
+				rate = std::max(rate * DECREASE_FACTOR, limit.rate * MIN_RATE_FACTOR);
+				decreasedAt = now;
+				ARRCON_LOG(LogLevel::Debug) << "Response latency rose to " << smoothedLatency.count() * 1000.0 << "ms (baseline " << baselineLatency.count() * 1000.0 << "ms); lowered the rate to " << rate << " commands per second." << std::endl;
+				smoothedLatency = seconds::zero(); //< start over with responses sent at the new rate
+			}
+			else rate = std::min(rate + limit.rate * INCREASE_STEP, limit.rate);
+		}
+	};
+}
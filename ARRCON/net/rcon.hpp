@@ -1,22 +1,49 @@
 #pragma once
 #include "../logging.hpp"
 #include "../ExceptionBuilder.hpp"
+#include "packet.hpp"
+#include "packet_reader.hpp"
+#include "dns_cache.hpp"
+#include "background_resolver.hpp"
+#include "command_dialect.hpp"
+#include "rate_limit.hpp"
+#include "response_end.hpp"
+#include "stats.hpp"
 
 // 307lib::TermAPI
 #include <Message.hpp>	//< for term::MessageMarginSize
 
 // Boost::asio
 #include <boost/asio.hpp>
+#include <boost/asio/awaitable.hpp>			//< for boost::asio::awaitable
+#include <boost/asio/co_spawn.hpp>			//< for boost::asio::co_spawn
+#include <boost/asio/use_awaitable.hpp>		//< for boost::asio::use_awaitable
+#include <boost/asio/redirect_error.hpp>	//< for boost::asio::redirect_error
+#include <boost/asio/use_future.hpp>		//< for boost::asio::use_future
+#include <boost/asio/detached.hpp>			//< for boost::asio::detached
 
 // STL
 #include <cstdint>	//< for sized integer types
 #include <vector>	//< for std::vector
 #include <string>	//< for std::string
+#include <string_view>	//< for std::string_view
 #include <iostream>	//< for std::clog
+#include <deque>		//< for std::deque
+#include <unordered_map>	//< for std::unordered_map
+#include <functional>	//< for std::function
+#include <memory>	//< for std::unique_ptr, std::shared_ptr
+#include <chrono>	//< for std::chrono
+#include <optional>	//< for std::optional
+#include <algorithm>	//< for std::min
+#include <tuple>		//< for std::tie
+#include <span>		//< for std::span
+#include <exception>	//< for std::exception_ptr
 
 namespace net {
 	using boost::asio::io_context;
 	using boost::asio::ip::tcp;
+	using boost::asio::awaitable;
+	using boost::asio::use_awaitable;
 
 	/**
 	 * @brief				Resolves a target endpoint from the specified host and port.
@@ -25,60 +52,99 @@ namespace net {
 	 * @param port		  -	The target port number.
 	 * @returns				The resolved target when successful; otherwise, std::nullopt.
 	 */
-	tcp::resolver::results_type resolve_targets(io_context& io_context, std::string_view host, std::string_view port)
+	inline tcp::resolver::results_type resolve_targets(io_context& io_context, std::string_view host, std::string_view port)
 	{
 		return tcp::resolver(io_context).resolve(host, port);
 	}
 
 	namespace rcon {
-		enum class PacketType : int32_t {
-			SERVERDATA_AUTH = 3,
-			SERVERDATA_AUTH_RESPONSE = 2,
-			SERVERDATA_EXECCOMMAND = 2,
-			SERVERDATA_RESPONSE_VALUE = 0,
-		};
-
-		inline constexpr const int32_t PACKETID_MIN{ 1 };
-		inline constexpr const int32_t PACKETID_MAX{ std::numeric_limits<int32_t>::max() };
+		/// @brief	Callback that receives each chunk of a response as soon as it is received.
+		using response_sink = std::function<void(std::string_view)>;
+		/// @brief	Callback that receives the index of a pipelined command, its complete response, and details about how it was received.
+		using pipelined_response_handler = std::function<void(size_t, std::string&&, response_info const&)>;
 
-		struct packet_header {
-			int32_t size{};
-			int32_t id{};
-			int32_t type{};
+		/// @brief	The result of asking a command_source for the next command.
+		enum class NextCommand : uint8_t {
+			/// @brief	The next command was provided.
+			Ready,
+			/// @brief	The next command isn't available yet. Only returned when the source wasn't asked to wait.
+			Pending,
+			/// @brief	There are no more commands.
+			Done,
 		};
-
-		inline constexpr int32_t get_packet_size(size_t const bodySize)
-		{
-			// 4 packet size bytes aren't included vvvvvvv
-			return (sizeof(packet_header) - sizeof(int32_t)) + bodySize + 2;
-		}
-
-		/// @brief	Minimum possible size of an RCON packet.
-		inline constexpr const int32_t PACKETSZ_MIN{ sizeof(packet_header) + 2 };
-		/// @brief	Maximum number of bytes that can be sent in a single packet, before being split between multiple packets.
-		inline constexpr const int32_t PACKETSZ_MAX_SEND{ 4096 };
-
 		/**
-		 * @brief			Converts the specified vector of bytes to a string by direct copying.
-		 * @param bytes	  -	A vector of bytes to convert to a readable string.
-		 * @returns			The string representation of the specified bytes.
+		 * @brief	Callback that provides commands one at a time, such as from a stream.
+		 *\n		It sets its first argument to a view of the next command, which must remain valid until the command's response has been
+		 *			 passed to the response handler; the second argument is true when it should wait for a command to become available
+		 *			 rather than return NextCommand::Pending.
 		 */
-		inline std::string bytes_to_string(std::vector<uint8_t> const& bytes)
-		{
-			std::string s{ bytes.size(), 0, std::allocator<char>() };
+		using command_source = std::function<NextCommand(std::string_view&, bool)>;
 
-			std::memcpy(const_cast<char*>(s.c_str()), bytes.data(), bytes.size());
+		class MultiplexedClient;
 
-			return s;
-		}
-
-		/// @brief	Source RCON client object.
+		/**
+		 * @brief	Source RCON client object.
+		 *\n		Every operation is implemented as a coroutine (the async_* methods) that runs on the client's io_context;
+		 *			 the blocking methods are thin wrappers that run the corresponding coroutine to completion.
+		 */
 		class RconClient {
+			/// @brief	Drives the client from its own I/O thread, so that it can be shared between threads.
+			friend class MultiplexedClient;
+
 			using buffer = std::vector<uint8_t>;
 
-			io_context ioContext;
+			/// @brief	The io_context owned by this client, or nullptr when an external io_context is used.
+			std::unique_ptr<io_context> ownedIoContext;
+			io_context& ioContext;
 			tcp::socket socket;
+			/// @brief	Receive buffer that incoming packets are parsed from.
+			packet_reader reader;
 			int32_t currentPacketid{ PACKETID_MIN };
+			/// @brief	Optional cache of resolved endpoints, or nullptr to always resolve targets.
+			DnsCache* dnsCache{ nullptr };
+			/// @brief	Optional resolver that may already be resolving the target in the background, or nullptr.
+			BackgroundResolver* backgroundResolver{ nullptr };
+			/// @brief	Optional token bucket that schedules when commands are sent, or nullptr to send them as soon as possible.
+			rate_limiter* rateLimiter{ nullptr };
+			/// @brief	The amount of time to wait for a connection attempt before starting an attempt with the next endpoint.
+			std::chrono::milliseconds connectAttemptDelay{ 250 };
+			/// @brief	The amount of time that DNS resolution and establishing the connection may take in total.
+			std::chrono::milliseconds connectTimeout{ 3000 };
+			/// @brief	The amount of time that sending the password and receiving the authentication response may take in total.
+			std::chrono::milliseconds authTimeout{ 3000 };
+			/// @brief	The amount of time that sending a command and receiving its complete response may take in total.
+			std::chrono::milliseconds commandTimeout{ 3000 };
+			/// @brief	How the end of each response is detected.
+			response_end_strategy responseEnd{};
+			/// @brief	How commands that are too large for a single packet are split.
+			Dialect dialect{ Dialect::None };
+			/// @brief	The words that are repeated before each part of a split Minecraft command.
+			std::string splitPrefix;
+			/// @brief	Latency histograms & traffic counters.
+			client_stats stats;
+
+			/// @brief	The point in time that the current operation must be completed by.
+			struct operation_deadline {
+				std::chrono::steady_clock::time_point expiry;
+				/// @brief	The timeout that the deadline was created from, used in the timeout error message.
+				std::chrono::milliseconds duration;
+				/// @brief	A short description of the operation, used in the timeout error message.
+				std::string_view what;
+			};
+			/// @brief	The deadline of the current operation, or std::nullopt when there isn't one.
+			std::optional<operation_deadline> deadline;
+
+			/// @brief	Sets the deadline of the current operation for the lifetime of the scope, then restores the previous deadline.
+			struct deadline_scope {
+				std::optional<operation_deadline>& deadline;
+				std::optional<operation_deadline> previous;
+
+				deadline_scope(std::optional<operation_deadline>& deadline, std::chrono::milliseconds const duration, std::string_view what) : deadline{ deadline }, previous{ deadline }
+				{
+					deadline.emplace(std::chrono::steady_clock::now() + duration, duration, what);
+				}
+				~deadline_scope() { deadline = previous; }
+			};
 
 			/**
 			 * @brief	Gets the next pseudo-unique packet ID.
@@ -92,101 +158,498 @@ namespace net {
 			}
 
 			/**
-			 * @brief			Creates a packet buffer from the specified header and body.
-			 * @param header  -	The pre-constructed packet header to use.
-			 * @param body	  -	The body string to use.
-			 * @returns			A buffer containing the packet's raw bytes.
+			 * @brief			Creates the header for a packet with the specified body size.
+			 * @param id	  -	The ID of the packet.
+			 * @param type	  -	The type of the packet.
+			 * @param bodySize -	The size of the packet body, excluding the terminator bytes.
+			 * @returns			The packet header.
 			 */
-			buffer build_packet(packet_header const& header, std::string const& body)
+			static constexpr packet_header make_header(int32_t const id, PacketType const type, size_t const bodySize)
 			{
-				// create a buffer with 2 extra bytes for the packet terminator bytes
-				buffer buf(sizeof(packet_header) + body.size() + 2, 0, std::allocator<uint8_t>());
+				return{ get_packet_size(bodySize), id, (int32_t)type };
+			}
 
-				// copy the buffer header into the buffer
-				std::memcpy(&buf[0], &header, sizeof(packet_header));
+			/**
+			 * @brief			Runs the specified coroutine on the io_context and blocks until it completes.
+			 *\n				When the io_context is external, it must be run by another thread.
+			 * @param op	  -	The coroutine to run.
+			 * @returns			The result of the coroutine.
+			 */
+			template<typename T>
+			T run_sync(awaitable<T> op) noexcept(false)
+			{
+				auto future{ boost::asio::co_spawn(ioContext, std::move(op), boost::asio::use_future) };
 
-				// copy the buffer body into the buffer
-				std::memcpy(&buf[0] + sizeof(packet_header), body.c_str(), body.size());
+				if (ownedIoContext) {
+					ioContext.restart();
+					ioContext.run();
+				}
 
-				return buf;
+				return future.get();
 			}
-			/// @brief	Builds a special blank terminator packet with the specified id.
-			buffer build_terminator_packet(int32_t const id)
+
+			/**
+			 * @brief			Awaits the specified operation, cancelling it if it doesn't complete before the deadline of the current operation.
+			 * @param target  -	The I/O object that the operation runs on, which is cancelled when the deadline is reached.
+			 * @param op	  -	The operation to await.
+			 * @param ec	  -	When the operation reports errors through an error code instead of throwing, the error code that it reports to.
+			 * @returns			The result of the operation. This is returned even when the deadline was reached, unless the operation failed.
+			 */
+			template<typename T, typename Cancellable>
+			awaitable<T> with_deadline(Cancellable& target, awaitable<T> op, boost::system::error_code const* ec = nullptr) noexcept(false)
 			{
-				return build_packet(packet_header{ get_packet_size(0), id, (int32_t)PacketType::SERVERDATA_RESPONSE_VALUE }, "");
+				if (!deadline.has_value())
+					co_return co_await std::move(op);
+
+				const auto current{ *deadline };
+				if (std::chrono::steady_clock::now() >= current.expiry)
+					throw make_exception("Timed out after ", current.duration.count(), "ms while ", current.what, '!');
+
+				// the timer handler may outlive this coroutine frame, so the shared state must be heap-allocated
+				struct timer_state {
+					bool timedOut{ false };
+					bool finished{ false };
+				};
+				const auto state{ std::make_shared<timer_state>() };
+				boost::asio::steady_timer timer{ ioContext };
+
+				timer.expires_at(current.expiry);
+				timer.async_wait([&target, state](boost::system::error_code const& ec) {
+					if (ec || state->finished) return; //< the timer was cancelled, or the operation already completed
+					state->timedOut = true;
+					if constexpr (requires(boost::system::error_code& cancel_ec) { target.cancel(cancel_ec); }) {
+						boost::system::error_code cancel_ec;
+						target.cancel(cancel_ec);
+					}
+					else target.cancel();
+				});
+
+				// cancel the timer when leaving this scope, regardless of how the operation completed
+				struct timer_guard {
+					boost::asio::steady_timer& timer;
+					timer_state& state;
+					~timer_guard()
+					{
+						state.finished = true;
+						timer.cancel();
+					}
+				} guard{ timer, *state };
+
+				std::optional<T> result;
+				try {
+					result.emplace(co_await std::move(op));
+				} catch (boost::system::system_error const&) {
+					if (!state->timedOut) throw;
+				}
+
+				// the operation may complete in the same turn that the timer expires, in which case its result must not be discarded
+				if (result.has_value() && !(state->timedOut && ec != nullptr && ec->failed()))
+					co_return std::move(*result);
+
+				throw make_exception("Timed out after ", current.duration.count(), "ms while ", current.what, '!');
 			}
 
 			/**
-			 * @brief		Sends a blank message terminator packet to the server.
-			 * @param ec  -	error_code reference to use for socket errors
-			 * @returns		The ID of the terminator packet.
+			 * @brief			Sends the specified buffer sequence to the server in a single (vectored) write.
+			 * @param buffers -	The buffer sequence to send.
+			 * @returns			A pair containing the number of bytes that were sent and the resulting error code.
 			 */
-			int32_t send_terminator_packet(boost::system::error_code& ec)
+			template<typename ConstBufferSequence>
+			awaitable<std::pair<size_t, boost::system::error_code>> async_send_buffers(ConstBufferSequence const& buffers)
 			{
-				const int32_t termPacketId{ get_next_packet_id() };
-				const buffer termPacket{ build_terminator_packet(termPacketId) };
-
-				// send the terminator packet to the server
-				if (boost::asio::write(socket, boost::asio::buffer(termPacket), ec) != termPacket.size())
-					return -1;
+				boost::system::error_code ec{};
+				const auto sent_bytes{ co_await with_deadline(socket, boost::asio::async_write(socket, buffers, boost::asio::redirect_error(use_awaitable, ec)), &ec) };
+				stats.bytesSent += sent_bytes;
+				co_return std::make_pair(sent_bytes, ec);
+			}
 
-				return termPacketId;
+			/// @brief	Waits until the rate limiter allows another command to be sent. Returns immediately when there is no rate limiter.
+			awaitable<void> async_wait_for_rate_limit()
+			{
+				if (rateLimiter == nullptr)
+					co_return;
+				if (const auto delay{ rateLimiter->ready_in() }; delay > delay.zero()) {
+					boost::asio::steady_timer timer{ ioContext, delay };
+					co_await timer.async_wait(use_awaitable);
+				}
 			}
 
 			/**
 			 * @brief	Receives a single RCON packet.
-			 * @returns	A pair containing the packet header and the packet body.
+			 *\n		Data is only read from the socket when the receive buffer doesn't already contain a complete packet.
+			 * @returns	The packet. Its body is only valid until the next call to async_recv().
 			 */
-			std::pair<packet_header, buffer> recv() noexcept(false)
+			awaitable<packet_view> async_recv() noexcept(false)
 			{
-				// error code
-				boost::system::error_code ec{};
+				while (true) {
+					if (const auto packet{ reader.parse_next() }; packet.has_value()) {
+						++stats.packetsReceived;
+						co_return packet.value();
+					}
+
+					// read as much as the socket has available
+					boost::system::error_code ec{};
+					const auto bytes{ co_await with_deadline(socket, socket.async_read_some(reader.prepare(), boost::asio::redirect_error(use_awaitable, ec)), &ec) };
+
+					// check for errors
+					if (ec)
+						throw make_exception("Failed to receive packet due to error: \"", ec.what(), "\"!");
+
+					reader.commit(bytes);
+					stats.bytesReceived += bytes;
+				}
+			}
+			/**
+			 * @brief			Receives a single RCON packet, unless none is received within the specified amount of time.
+			 * @param gap	  -	The amount of time to wait for a packet.
+			 * @returns			The packet when one was received in time; otherwise, std::nullopt. Its body is only valid until the next call to async_recv().
+			 */
+			awaitable<std::optional<packet_view>> async_recv_within(std::chrono::milliseconds const gap) noexcept(false)
+			{
+				const auto gapExpiry{ std::chrono::steady_clock::now() + gap };
+				if (deadline.has_value() && deadline->expiry <= gapExpiry) // the deadline of the current operation comes first, so timing out is an error
+					co_return co_await async_recv();
+
+				deadline_scope scope{ deadline, gap, "waiting for more of the response" };
+
+				std::exception_ptr error;
+				try {
+					co_return co_await async_recv();
+				} catch (...) {
+					error = std::current_exception();
+				}
+
+				if (std::chrono::steady_clock::now() >= gapExpiry)
+					co_return std::nullopt;
+				std::rethrow_exception(error);
+			}
+
+			/**
+			 * @brief				Sends the packets of a command, and throws when they weren't sent completely.
+			 * @param buffers	  -	The buffer sequence to send.
+			 * @param packetId	  -	The ID of the command packet, used in the error message.
+			 * @param command	  -	The command, used in the error message.
+			 */
+			template<typename ConstBufferSequence>
+			awaitable<void> async_send_command_buffers(ConstBufferSequence const& buffers, int32_t const packetId, std::string_view command) noexcept(false)
+			{
+				const auto totalSize{ boost::asio::buffer_size(buffers) };
+				if (const auto [sent_bytes, ec] { co_await async_send_buffers(buffers) };
+					sent_bytes != totalSize || ec) {
+					// an error occurred:
+					const auto error_message{
+						sent_bytes == totalSize
+						? str::stringify("Sent ", sent_bytes, '/', totalSize, " bytes of packet #", packetId, " with command \"", command, "\", but an error occurred: ", ec.what())
+						: str::stringify("Sent ", sent_bytes, '/', totalSize, " bytes of packet #", packetId, " with command \"", command, "\" due to error: ", ec.what())
+					};
+
+					ARRCON_LOG(LogLevel::Error) << error_message << std::endl;
+					throw make_exception(error_message);
+				}
+			}
+
+			/**
+			 * @brief				Sends a command that is too large for a single packet as several command packets, followed by a message terminator packet.
+			 *\n					Every part has the same packet ID, so the responses to all of them are received as the response to the command.
+			 *					 Each packet is written directly from the command string as soon as it is split off, without allocating a buffer for it.
+			 * @param command	  -	The command to send to the RCON server. This must outlive the operation.
+			 * @param splitter	  -	The splitter of the command.
+			 * @param packetId	  -	The ID of the command packets.
+			 * @param termPacketId -	The ID of the terminator packet.
+			 * @param withTerminator -	When false, only the command packets are sent.
+			 */
+			awaitable<void> async_send_command_parts(std::string_view command, command_splitter splitter, int32_t const packetId, int32_t const termPacketId, bool const withTerminator) noexcept(false)
+			{
+				const auto sendStart{ std::chrono::steady_clock::now() };
+				size_t parts{ 0 };
+				for (std::string_view prefix, part; splitter.next(prefix, part); ++parts) {
+					const packet_header header{ make_header(packetId, PacketType::SERVERDATA_EXECCOMMAND, prefix.size() + part.size()) };
+					const std::array<boost::asio::const_buffer, 4> buffers{
+						boost::asio::buffer(&header, sizeof(packet_header)),
+						boost::asio::buffer(prefix),
+						boost::asio::buffer(part),
+						boost::asio::buffer(PACKET_TERMINATOR),
+					};
+					co_await async_send_command_buffers(buffers, packetId, command);
+
+					ARRCON_LOG(LogLevel::Trace) << "Sent part " << parts + 1 << " of packet #" << packetId << " with " << prefix.size() + part.size() << " bytes." << std::endl;
+				}
+				if (withTerminator) {
+					const packet_header header{ make_header(termPacketId, PacketType::SERVERDATA_RESPONSE_VALUE, 0) };
+					const std::array<boost::asio::const_buffer, 2> buffers{
+						boost::asio::buffer(&header, sizeof(packet_header)),
+						boost::asio::buffer(PACKET_TERMINATOR),
+					};
+					co_await async_send_command_buffers(buffers, packetId, command);
+				}
+
+				stats.record(Phase::Send, std::chrono::steady_clock::now() - sendStart);
+				stats.packetsSent += withTerminator ? parts + 1 : parts;
 
-				// read the packet header
-				packet_header header{};
-				boost::asio::mutable_buffer buf(&header, sizeof(packet_header));
-				boost::asio::read(socket, buf, ec);
+				ARRCON_LOG(LogLevel::Debug) << "Sent packet #" << packetId << " with command \"" << command << "\" split into " << parts << " parts." << std::endl;
+			}
+
+			/**
+			 * @brief				Sends a command packet with the specified IDs, followed by a message terminator packet.
+			 *\n					Both packets are sent in a single vectored write directly from the command string, without building a packet buffer.
+			 *					 Commands that are too large for a single packet are split according to the dialect.
+			 * @param command	  -	The command to send to the RCON server. This must outlive the operation.
+			 * @param packetId	  -	The ID of the command packet.
+			 * @param termPacketId -	The ID of the terminator packet.
+			 * @param withTerminator -	When false, only the command packet is sent.
+			 */
+			awaitable<void> async_send_command(std::string_view command, int32_t const packetId, int32_t const termPacketId, bool const withTerminator) noexcept(false)
+			{
+				if (command_splitter splitter{ command, dialect, splitPrefix }; !splitter.is_single()) {
+					co_await async_send_command_parts(command, splitter, packetId, termPacketId, withTerminator);
+					co_return;
+				}
+				else if (command.size() > MAX_COMMAND_BODY_SIZE)
+					ARRCON_LOG(LogLevel::Warning) << "Sending a command of " << command.size() << " bytes in a single packet, which most servers truncate or drop; set the server dialect to split it." << std::endl;
+
+				// the command packet is followed by a blank terminator packet, which marks the end of the response
+				const std::array<packet_header, 2> headers{
+					make_header(packetId, PacketType::SERVERDATA_EXECCOMMAND, command.size()),
+					make_header(termPacketId, PacketType::SERVERDATA_RESPONSE_VALUE, 0),
+				};
+				const std::array<boost::asio::const_buffer, 5> buffers{
+					boost::asio::buffer(&headers[0], sizeof(packet_header)),
+					boost::asio::buffer(command),
+					boost::asio::buffer(PACKET_TERMINATOR),
+					boost::asio::buffer(&headers[1], sizeof(packet_header)),
+					boost::asio::buffer(PACKET_TERMINATOR),
+				};
+				const auto commandBuffers{ std::span{ buffers }.first(withTerminator ? buffers.size() : 3) };
+
+				// send the command & terminator packets to the server
+				const auto sendStart{ std::chrono::steady_clock::now() };
+				co_await async_send_command_buffers(commandBuffers, packetId, command);
+
+				stats.record(Phase::Send, std::chrono::steady_clock::now() - sendStart);
+				stats.packetsSent += withTerminator ? 2 : 1;
+
+				ARRCON_LOG(LogLevel::Debug) << "Sent packet #" << packetId << " with command \"" << command << '\"' << std::endl;
+			}
+			/**
+			 * @brief				Sends a command packet followed by a message terminator packet.
+			 * @param command	  -	The command to send to the RCON server. This must outlive the operation.
+			 * @param withTerminator -	When false, only the command packet is sent.
+			 * @returns				A pair containing the ID of the command packet and the ID of the terminator packet.
+			 */
+			awaitable<std::pair<int32_t, int32_t>> async_send_command(std::string_view command, bool const withTerminator = true) noexcept(false)
+			{
+				const auto packetId{ get_next_packet_id() };
+				const auto termPacketId{ get_next_packet_id() };
+				co_await async_send_command(command, packetId, termPacketId, withTerminator);
+				co_return std::make_pair(packetId, termPacketId);
+			}
+
+			/// @brief	State shared between the concurrent connection attempts started by async_connect_endpoints.
+			struct connect_race {
+				/// @brief	The socket of each attempt. A deque is used so that sockets don't move while they're connecting.
+				std::deque<tcp::socket> sockets;
+				/// @brief	Timer that is cancelled to wake the waiting coroutine whenever an attempt completes.
+				boost::asio::steady_timer notify;
+				std::optional<size_t> winner;
+				boost::system::error_code lastError{ boost::asio::error::host_not_found };
+				size_t active{ 0 };
+
+				connect_race(io_context& ioContext) : notify{ ioContext } {}
+			};
 
-				// check for errors
-				if (ec)
-					throw make_exception("Failed to read packet header due to error: \"", ec.what(), "\"!");
+			/**
+			 * @brief				Reorders endpoints so that the address families alternate, starting with the family of the first endpoint (RFC 8305 §4).
+			 * @param endpoints	  -	The resolved endpoints, in the order returned by the resolver.
+			 * @returns				The reordered endpoints.
+			 */
+			static std::vector<tcp::endpoint> interleave_address_families(std::vector<tcp::endpoint> const& endpoints)
+			{
+				if (endpoints.empty()) return {};
 
-				// read the packet body
-				const auto avail{ socket.available() };
-				const auto bodySize{ header.size - (sizeof(packet_header) - sizeof(int32_t)) };
-				buffer body_buffer{ bodySize, 0, std::allocator<uint8_t>() };
-				boost::asio::read(socket, boost::asio::buffer(body_buffer), ec); //< TODO: validate received byte count
+				const bool firstIsV6{ endpoints.front().address().is_v6() };
+				std::vector<tcp::endpoint> preferred, other;
+				for (const auto& endpoint : endpoints) {
+					(endpoint.address().is_v6() == firstIsV6 ? preferred : other).emplace_back(endpoint);
+				}
 
-				// check for errors
-				if (ec)
-					throw make_exception("Failed to read packet body due to error: \"", ec.what(), "\"!");
+				std::vector<tcp::endpoint> result;
+				result.reserve(endpoints.size());
+				for (size_t i{ 0 }; i < preferred.size() || i < other.size(); ++i) {
+					if (i < preferred.size()) result.emplace_back(preferred[i]);
+					if (i < other.size()) result.emplace_back(other[i]);
+				}
+				return result;
+			}
+
+			/**
+			 * @brief				A single connection attempt started by async_connect_endpoints.
+			 * @param race		  -	The shared state of the connection attempts.
+			 * @param index		  -	The index of the attempt's socket.
+			 * @param endpoint	  -	The endpoint to connect to.
+			 */
+			static awaitable<void> async_connect_attempt(std::shared_ptr<connect_race> race, size_t index, tcp::endpoint endpoint)
+			{
+				boost::system::error_code ec;
+				co_await race->sockets[index].async_connect(endpoint, boost::asio::redirect_error(use_awaitable, ec));
+				--race->active;
 
-				// remove the null terminators from the body buffer
-				body_buffer.erase(std::remove(body_buffer.begin(), body_buffer.end(), '\0'), body_buffer.end());
+				if (!ec) {
+					if (!race->winner) race->winner = index;
+				}
+				else if (!race->winner) {
+					ARRCON_LOG(LogLevel::Debug) << "Failed to connect to endpoint \"" << endpoint << "\" due to error: " << ec.message() << std::endl;
+					race->lastError = ec;
+				}
 
-				return std::make_pair(header, body_buffer);
+				// wake up async_connect_endpoints
+				race->notify.cancel();
+			}
+
+			/**
+			 * @brief				Connects the socket to the first of the specified endpoints that accepts the connection.
+			 *\n					Connection attempts are started one at a time, each after the previous attempt fails or the
+			 *						 attempt delay elapses, so that an unreachable endpoint doesn't delay the others (RFC 8305).
+			 * @param endpoints	  -	The resolved endpoints to connect to.
+			 * @returns				A pair containing the endpoint that was connected to and the resulting error code.
+			 */
+			awaitable<std::pair<tcp::endpoint, boost::system::error_code>> async_connect_endpoints(std::vector<tcp::endpoint> const& endpoints)
+			{
+				const auto ordered{ interleave_address_families(endpoints) };
+				const auto race{ std::make_shared<connect_race>(ioContext) };
+				const auto expiry{ deadline ? deadline->expiry : std::chrono::steady_clock::now() + connectTimeout };
+				bool timedOut{ false };
+
+				for (size_t next{ 0 }; !race->winner;) {
+					if (next < ordered.size()) {
+						// start the next attempt
+						ARRCON_LOG(LogLevel::Trace) << "Attempting to connect to endpoint \"" << ordered[next] << '\"' << std::endl;
+						race->sockets.emplace_back(ioContext);
+						++race->active;
+						boost::asio::co_spawn(ioContext, async_connect_attempt(race, next, ordered[next]), boost::asio::detached);
+						++next;
+					}
+					else if (race->active == 0) break; //< every attempt failed
+
+					const auto now{ std::chrono::steady_clock::now() };
+					if (now >= expiry) {
+						timedOut = true;
+						break;
+					}
+
+					// wait until an attempt completes, the attempt delay elapses, or the deadline is reached
+					boost::system::error_code ec;
+					race->notify.expires_at(next < ordered.size() ? std::min(now + connectAttemptDelay, expiry) : expiry);
+					co_await race->notify.async_wait(boost::asio::redirect_error(use_awaitable, ec));
+				}
+
+				// close the sockets of the other attempts
+				for (size_t i{ 0 }; i < race->sockets.size(); ++i) {
+					if (race->winner == i) continue;
+					boost::system::error_code ec;
+					race->sockets[i].close(ec);
+				}
+
+				if (!race->winner)
+					co_return std::make_pair(tcp::endpoint{}, timedOut ? boost::system::error_code{ boost::asio::error::timed_out } : race->lastError);
+
+				socket = std::move(race->sockets[*race->winner]);
+				co_return std::make_pair(ordered[*race->winner], boost::system::error_code{});
+			}
+
+			/**
+			 * @brief				Sends a command without a terminator packet, and receives its response until the response end strategy determines that it's complete.
+			 * @param command	  -	The command to send to the RCON server. This must outlive the operation.
+			 * @param sink		  -	Callback that receives each chunk of the response.
+			 * @returns				The number of response packets that were received.
+			 */
+			awaitable<response_info> async_command_unterminated(std::string_view command, response_sink const& sink) noexcept(false)
+			{
+				const auto sentAt{ std::chrono::steady_clock::now() };
+				const auto packetId{ (co_await async_send_command(command, false)).first };
+				// a command that was split into several packets receives a response to each of them
+				size_t remainingResponses{ command_splitter{ command, dialect, splitPrefix }.count() };
+
+				response_info info;
+				size_t& receivedPackets{ info.packets };
+				auto lastPacketAt{ sentAt };
+
+				// wait for the first response packet until the deadline, then only wait for more during the idle gap
+				for (std::optional<packet_view> response{ co_await async_recv() }; response.has_value();) {
+					if (response->header.id != packetId) {
+						ARRCON_LOG(LogLevel::Trace) << "Discarded unexpected packet with ID " << response->header.id << '.' << std::endl;
+					}
+					else {
+						lastPacketAt = std::chrono::steady_clock::now();
+						if (receivedPackets++ == 0) {
+							info.firstByte = lastPacketAt - sentAt;
+							stats.record(Phase::FirstByte, info.firstByte);
+						}
+						sink(response->body);
+
+						if ((responseEnd.mode == ResponseEnd::Single
+							|| (responseEnd.mode == ResponseEnd::Size && response->body.size() < get_response_fragment_body_size(dialect)))
+							&& --remainingResponses == 0)
+							break;
+					}
+
+					if (receivedPackets == 0)
+						response = co_await async_recv();
+					else
+						response = co_await async_recv_within(responseEnd.idleGap);
+				}
+
+				// the idle gap that ended the response isn't included
+				info.lastByte = lastPacketAt - sentAt;
+				stats.record(Phase::LastByte, info.lastByte);
+				++stats.commands;
+
+				ARRCON_LOG(LogLevel::Debug) << "Received " << receivedPackets << " response packet" << (receivedPackets == 1 ? "" : "s") << '.' << std::endl;
+
+				co_return info;
 			}
 
 		public:
+			/// @brief	Creates a new RconClient instance that uses its own io_context.
+			RconClient() : ownedIoContext{ std::make_unique<io_context>() }, ioContext{ *ownedIoContext }, socket{ ioContext } {}
 			/**
-			 * @brief			Creates a new RconClient instance and connects it to the specified endpoint.
-			 * @param host    -	The hostname of the target endpoint.
-			 * @param port	  -	The port of the target endpoint.
+			 * @brief				Creates a new RconClient instance that runs on the specified io_context.
+			 *\n					The blocking methods may only be used while another thread is running the io_context.
+			 * @param ioContext	  -	An external io_context that outlives the client.
 			 */
-			RconClient() : socket{ ioContext } {}
+			explicit RconClient(io_context& ioContext) : ioContext{ ioContext }, socket{ ioContext } {}
 			~RconClient()
 			{
-				ioContext.run(); //< wait for async operations to finish
-				socket.close(); //< close the socket
+				close();
 			}
 
-			/// @brief	Connects the RCON client to the specified endpoint.
-			void connect(std::string_view host, std::string_view port) noexcept(false)
+			/// @brief	Closes the connection, which makes the pending operation (if there is one) fail.
+			void close() noexcept
 			{
-				// resolve DNS
-				tcp::resolver::results_type targets;
+				boost::system::error_code ec;
+				socket.close(ec); //< close the socket
+			}
+
+			/// @brief	Gets the io_context that the client runs on.
+			io_context& get_io_context() noexcept { return ioContext; }
+			/// @brief	Gets the latency histograms & traffic counters recorded by the client.
+			client_stats const& get_stats() const noexcept { return stats; }
+
+			/**
+			 * @brief			Resolves the endpoints of the specified host and port, and adds them to the DNS cache when one is set.
+			 * @param host	  -	The target hostname or IP.
+			 * @param port	  -	The target port.
+			 * @returns			The resolved endpoints.
+			 */
+			awaitable<std::vector<tcp::endpoint>> async_resolve(std::string const& host, std::string const& port) noexcept(false)
+			{
+				std::vector<tcp::endpoint> endpoints;
 				try {
-					targets = resolve_targets(ioContext, host, port); //< this throws on failure & can't use boost::system::error_code
+					tcp::resolver resolver{ ioContext };
+					const auto start{ std::chrono::steady_clock::now() };
+					for (const auto& result : co_await with_deadline(resolver, resolver.async_resolve(host, port, use_awaitable))) {
+						endpoints.emplace_back(result.endpoint());
+					}
+					stats.record(Phase::Resolve, std::chrono::steady_clock::now() - start);
 				} catch (std::exception const& ex) {
 					// rethrow with stacktrace & custom message
 					throw ExceptionBuilder()
@@ -200,14 +663,63 @@ namespace net {
 						.build();
 				}
 
-				std::clog << MessageHeader(LogLevel::Debug) << "Resolved \"" << host << ':' << port << "\" to " << targets.size() << " endpoint" << (targets.size() == 1 ? "" : "s") << ':' << std::endl;
-				for (const auto& target : targets) {
-					std::clog << BlankHeader() << "- \"" << target.endpoint() << '\"' << std::endl;
+				on_resolved(host, port, endpoints);
+
+				co_return endpoints;
+			}
+			/// @brief	Logs the endpoints that a target resolved to, and adds them to the DNS cache when one is set.
+			void on_resolved(std::string const& host, std::string const& port, std::vector<tcp::endpoint> const& endpoints)
+			{
+				if (is_log_enabled(LogLevel::Debug)) {
+					ARRCON_LOG(LogLevel::Debug) << "Resolved \"" << host << ':' << port << "\" to " << endpoints.size() << " endpoint" << (endpoints.size() == 1 ? "" : "s") << ':' << std::endl;
+					for (const auto& endpoint : endpoints) {
+						std::clog << BlankHeader() << "- \"" << endpoint << '\"' << std::endl;
+					}
+				}
+
+				if (dnsCache) dnsCache->put(host, port, endpoints);
+			}
+
+			/// @brief	Connects the RCON client to the specified endpoint.
+			awaitable<void> async_connect(std::string host, std::string port) noexcept(false)
+			{
+				deadline_scope scope{ deadline, connectTimeout, "connecting" };
+
+				// resolve DNS, unless the target is already cached
+				std::vector<tcp::endpoint> targets;
+				bool cached{ false };
+				if (dnsCache) {
+					if (auto cachedTargets{ dnsCache->get(host, port) }) {
+						targets = std::move(*cachedTargets);
+						cached = true;
+						ARRCON_LOG(LogLevel::Debug) << "Using " << targets.size() << " cached endpoint" << (targets.size() == 1 ? "" : "s") << " for \"" << host << ':' << port << '\"' << std::endl;
+					}
 				}
+				if (!cached && backgroundResolver != nullptr && backgroundResolver->matches(host, port)) {
+					// use the endpoints that were resolved in the background, waiting for them if necessary
+					const auto start{ std::chrono::steady_clock::now() };
+					auto resolved{ co_await backgroundResolver->async_wait_until(deadline->expiry) };
+					if (resolved.has_value()) {
+						stats.record(Phase::Resolve, std::chrono::steady_clock::now() - start);
+						targets = std::move(*resolved);
+						on_resolved(host, port, targets);
+					}
+				}
+				if (targets.empty())
+					targets = co_await async_resolve(host, port);
 
 				// connect to the target
-				boost::system::error_code ec{};
-				tcp::endpoint endpoint{ boost::asio::connect(socket, targets, ec) };
+				auto connectStart{ std::chrono::steady_clock::now() };
+				auto [endpoint, ec] { co_await async_connect_endpoints(targets) };
+
+				if (ec && cached) {
+					// the cached endpoints may be stale; resolve the target again and retry
+					ARRCON_LOG(LogLevel::Debug) << "Failed to connect to the cached endpoints for \"" << host << ':' << port << "\"; resolving again." << std::endl;
+					dnsCache->erase(host, port);
+					targets = co_await async_resolve(host, port);
+					connectStart = std::chrono::steady_clock::now();
+					std::tie(endpoint, ec) = co_await async_connect_endpoints(targets);
+				}
 
 				if (ec) {
 					// an error occurred
@@ -222,9 +734,99 @@ namespace net {
 						.line("2.  Verify that port ", port, " is accessible from your network.")
 						.build();
 				}
-				else std::clog << MessageHeader(LogLevel::Debug) << "Connected to endpoint \"" << endpoint << '\"' << std::endl;;
+				else ARRCON_LOG(LogLevel::Debug) << "Connected to endpoint \"" << endpoint << '\"' << std::endl;
+				stats.record(Phase::Connect, std::chrono::steady_clock::now() - connectStart);
+
+				// disable Nagle's algorithm so small command packets are sent immediately
+				if (socket.set_option(tcp::no_delay{ true }, ec); ec)
+					ARRCON_LOG(LogLevel::Warning) << "Failed to set TCP_NODELAY due to error: " << ec.message() << std::endl;
+			}
+			/// @brief	Connects the RCON client to the specified endpoint.
+			void connect(std::string_view host, std::string_view port) noexcept(false)
+			{
+				run_sync(async_connect(std::string{ host }, std::string{ port }));
+			}
+
+			/**
+			 * @brief				Sends a command to the RCON server and passes the body of each response packet to the sink as soon as it is received.
+			 * @param command	  -	The command to send to the RCON server. This must outlive the operation.
+			 * @param sink		  -	Callback that receives each chunk of the response. Chunks are only valid for the duration of the call.
+			 * @returns				The number of response packets that were received, and how long they took to arrive.
+			 */
+			awaitable<response_info> async_command(std::string_view command, response_sink sink) noexcept(false)
+			{
+				// the time spent waiting for the rate limiter doesn't count towards the command timeout
+				co_await async_wait_for_rate_limit();
+				if (rateLimiter != nullptr)
+					rateLimiter->take();
+
+				deadline_scope scope{ deadline, commandTimeout, "waiting for a response" };
+
+				if (responseEnd.mode != ResponseEnd::Terminator) {
+					const auto info{ co_await async_command_unterminated(command, sink) };
+					if (rateLimiter != nullptr)
+						rateLimiter->observe(info.lastByte);
+					co_return info;
+				}
+
+				const auto sentAt{ std::chrono::steady_clock::now() };
+				const auto [packetId, termPacketId] { co_await async_send_command(command) };
+
+				response_info info;
+				size_t& receivedPackets{ info.packets };
+
+				// receive the response until the terminator packet is echoed back
+				for (auto response{ co_await async_recv() };
+					 response.header.id != termPacketId;
+					 response = co_await async_recv()) {
+					if (response.header.id != packetId) {
+						ARRCON_LOG(LogLevel::Trace) << "Discarded unexpected packet with ID " << response.header.id << '.' << std::endl;
+						continue;
+					}
+
+					if (receivedPackets++ == 0) {
+						info.firstByte = std::chrono::steady_clock::now() - sentAt;
+						stats.record(Phase::FirstByte, info.firstByte);
+					}
+					sink(response.body);
+				}
+
+				info.lastByte = std::chrono::steady_clock::now() - sentAt;
+				if (receivedPackets == 0) { // the response is empty
+					info.firstByte = info.lastByte;
+					stats.record(Phase::FirstByte, info.firstByte);
+				}
+				stats.record(Phase::LastByte, info.lastByte);
+				++stats.commands;
+				if (rateLimiter != nullptr)
+					rateLimiter->observe(info.lastByte);
+
+				ARRCON_LOG(LogLevel::Debug) << "Received " << receivedPackets << " response packet" << (receivedPackets == 1 ? "" : "s") << '.' << std::endl;
+
+				co_return info;
+			}
+			/**
+			 * @brief				Sends a command to the RCON server and passes the body of each response packet to the sink as soon as it is received.
+			 * @param command	  -	The command to send to the RCON server.
+			 * @param sink		  -	Callback that receives each chunk of the response. Chunks are only valid for the duration of the call.
+			 * @returns				The number of response packets that were received, and how long they took to arrive.
+			 */
+			response_info command(std::string_view command, response_sink const& sink) noexcept(false)
+			{
+				return run_sync(async_command(command, sink));
 			}
 
+			/**
+			 * @brief				Sends a command to the RCON server and returns the response.
+			 * @param command	  -	The command to send to the RCON server.
+			 * @returns				The response from the RCON server when successful.
+			 */
+			awaitable<std::string> async_command(std::string command) noexcept(false)
+			{
+				std::string responseBody;
+				co_await async_command(command, [&responseBody](std::string_view chunk) { responseBody.append(chunk); });
+				co_return responseBody;
+			}
 			/**
 			 * @brief				Sends a command to the RCON server and returns the response.
 			 * @param command	  -	The command to send to the RCON server.
@@ -232,46 +834,180 @@ namespace net {
 			 */
 			std::string command(std::string const& command) noexcept(false)
 			{
-				boost::system::error_code ec{};
-
-				// build the command packet
-				const auto packetId{ get_next_packet_id() };
-				const buffer packet{ build_packet(packet_header{ get_packet_size(command.size()), packetId, (int32_t)PacketType::SERVERDATA_EXECCOMMAND }, command) };
+				return run_sync(async_command(command));
+			}
 
-				// send the command packet to the server
-				if (const auto sent_bytes{ boost::asio::write(socket, boost::asio::buffer(packet), ec) };
-					sent_bytes != packet.size() || ec) {
-					// an error occurred:
-					const auto error_message{
-						sent_bytes == packet.size()
-						? str::stringify("Sent ", sent_bytes, '/', packet.size(), " bytes of packet #", packetId, " with command \"", command, "\", but an error occurred: ", ec.what())
-						: str::stringify("Sent ", sent_bytes, '/', packet.size(), " bytes of packet #", packetId, " with command \"", command, "\" due to error: ", ec.what())
-					};
+			/**
+			 * @brief				Sends multiple commands to the RCON server, keeping up to depth commands in flight at once.
+			 *\n					Responses are demultiplexed by packet ID and passed to the callback in submission order.
+			 *\n					The source is only asked to wait for the next command when no commands are awaiting a response,
+			 *					 so responses are handled as soon as they arrive even when the source is slow.
+			 *					 Likewise, responses are received while waiting for the rate limiter to allow the next command.
+			 * @param next		  -	Provides the commands to send to the RCON server, in order.
+			 * @param depth		  -	The maximum number of commands that may be awaiting a response at any given time.
+			 * @param onResponse  -	Callback that is invoked with the index of each command, its response, and details about how it was received.
+			 */
+			awaitable<void> async_command_pipelined(command_source next, size_t depth, pipelined_response_handler onResponse) noexcept(false)
+			{
+				if (depth == 0)
+					throw make_exception("Invalid pipeline depth \"0\"; the depth must be at least 1!");
 
-					std::clog << MessageHeader(LogLevel::Error) << error_message << std::endl;
-					throw make_exception(error_message);
+				if (responseEnd.mode != ResponseEnd::Terminator) {
+					// without terminators, responses to different commands can't be told apart reliably; send them one at a time instead
+					std::string_view command;
+					for (size_t i{ 0 }; next(command, true) == NextCommand::Ready; ++i) {
+						std::string response;
+						const auto info{ co_await async_command(command, [&response](std::string_view chunk) { response.append(chunk); }) };
+						onResponse(i, std::move(response), info);
+					}
+					co_return;
 				}
 
-				std::clog << MessageHeader(LogLevel::Debug) << "Sent packet #" << packetId << " with command \"" << command << '\"' << std::endl;
+				struct pending_command {
+					size_t index;
+					std::string_view command;
+					int32_t packetId{ 0 };
+					int32_t termPacketId{ 0 };
+					std::chrono::steady_clock::time_point sentAt{};
+					std::stringstream responseBody;
+					response_info info{};
+					bool complete{ false };
+				};
+				// in-flight commands, in submission order (references to elements remain valid when pushing/popping the ends)
+				std::deque<pending_command> inFlight;
+				// maps packet IDs to their in-flight command
+				std::unordered_map<int32_t, pending_command*> packetIdMap;
 
-				// send the message terminator packet
-				const int32_t termPacketId{ send_terminator_packet(ec) };
+				// each command has its own deadline; the deadline of the oldest in-flight command applies to every operation
+				deadline_scope scope{ deadline, commandTimeout, "waiting for a response" };
 
-				std::stringstream responseBody;
-				int32_t receivedPackets{ 0 };
-				std::pair<packet_header, buffer> response;
+				bool exhausted{ false };
 
-				// receive the response
-				for (response = recv(), receivedPackets = 1;
-					 response.first.id == packetId;
-					 response = recv(), ++receivedPackets) {
-					responseBody << bytes_to_string(response.second);
-				}
+				for (size_t nextIndex{ 0 }; !exhausted || !inFlight.empty(); ) {
+					// the amount of time until the rate limiter allows the next command to be sent
+					std::chrono::steady_clock::duration sendDelay{ 0 };
+
+					// fill the pipeline
+					while (!exhausted && inFlight.size() < depth) {
+						if (rateLimiter != nullptr) {
+							if (inFlight.empty())
+								co_await async_wait_for_rate_limit();
+							else if (sendDelay = rateLimiter->ready_in(); sendDelay > sendDelay.zero())
+								break; //< receive responses until the next command may be sent
+						}
 
-				std::clog                   // subtract 1 because of terminator packet  vvv
-					<< MessageHeader(LogLevel::Debug) << "Received " << receivedPackets - 1 << " response packet" << (receivedPackets == 1 ? "" : "s") << '.' << std::endl;
+						std::string_view command;
+						if (const auto state{ next(command, inFlight.empty()) }; state == NextCommand::Done) {
+							exhausted = true;
+							break;
+						}
+						else if (state == NextCommand::Pending)
+							break;
 
-				return responseBody.str();
+						if (rateLimiter != nullptr)
+							rateLimiter->take();
+
+						const auto sentAt{ std::chrono::steady_clock::now() };
+						if (inFlight.empty())
+							deadline->expiry = sentAt + commandTimeout;
+
+						auto& cmd{ inFlight.emplace_back(nextIndex++, command) };
+						std::tie(cmd.packetId, cmd.termPacketId) = co_await async_send_command(cmd.command);
+						cmd.sentAt = sentAt;
+						packetIdMap[cmd.packetId] = &cmd;
+						packetIdMap[cmd.termPacketId] = &cmd;
+					}
+					if (inFlight.empty())
+						continue;
+
+					// receive the next packet & route it to the command it belongs to
+					std::optional<packet_view> nextPacket;
+					if (sendDelay > sendDelay.zero())
+						nextPacket = co_await async_recv_within(std::chrono::ceil<std::chrono::milliseconds>(sendDelay));
+					else
+						nextPacket = co_await async_recv();
+					if (!nextPacket.has_value())
+						continue; //< the next command may be sent now
+					const auto& response{ *nextPacket };
+
+					const auto it{ packetIdMap.find(response.header.id) };
+					if (it == packetIdMap.end()) {
+						ARRCON_LOG(LogLevel::Trace) << "Discarded unexpected packet with ID " << response.header.id << '.' << std::endl;
+						continue;
+					}
+
+					auto& cmd{ *it->second };
+					const auto elapsed{ std::chrono::steady_clock::now() - cmd.sentAt };
+					if (cmd.info.packets == 0) {
+						cmd.info.firstByte = elapsed;
+						stats.record(Phase::FirstByte, elapsed);
+					}
+
+					if (response.header.id == cmd.packetId) {
+						cmd.responseBody << response.body;
+						++cmd.info.packets;
+						continue;
+					}
+
+					// received the terminator for this command
+					cmd.info.lastByte = elapsed;
+					stats.record(Phase::LastByte, elapsed);
+					++stats.commands;
+					if (rateLimiter != nullptr)
+						rateLimiter->observe(elapsed);
+					cmd.complete = true;
+					packetIdMap.erase(cmd.packetId);
+					packetIdMap.erase(cmd.termPacketId);
+
+					ARRCON_LOG(LogLevel::Debug) << "Received " << cmd.info.packets << " response packet" << (cmd.info.packets == 1 ? "" : "s") << " for packet #" << cmd.packetId << '.' << std::endl;
+
+					// pass completed responses to the callback in submission order
+					while (!inFlight.empty() && inFlight.front().complete) {
+						onResponse(inFlight.front().index, inFlight.front().responseBody.str(), inFlight.front().info);
+						inFlight.pop_front();
+					}
+					if (!inFlight.empty())
+						deadline->expiry = inFlight.front().sentAt + commandTimeout;
+				}
+			}
+			/**
+			 * @brief				Sends multiple commands to the RCON server, keeping up to depth commands in flight at once.
+			 *\n					Responses are demultiplexed by packet ID and passed to the callback in submission order.
+			 * @param commands	  -	The commands to send to the RCON server. These must outlive the operation.
+			 * @param depth		  -	The maximum number of commands that may be awaiting a response at any given time.
+			 * @param onResponse  -	Callback that is invoked with the index of each command, its response, and details about how it was received.
+			 */
+			awaitable<void> async_command_pipelined(std::vector<std::string> const& commands, size_t depth, pipelined_response_handler onResponse) noexcept(false)
+			{
+				size_t index{ 0 };
+				co_await async_command_pipelined([&commands, &index](std::string_view& command, bool) {
+					if (index == commands.size())
+						return NextCommand::Done;
+					command = commands[index++];
+					return NextCommand::Ready;
+				}, depth, std::move(onResponse));
+			}
+			/**
+			 * @brief				Sends multiple commands to the RCON server, keeping up to depth commands in flight at once.
+			 *\n					Responses are demultiplexed by packet ID and passed to the callback in submission order.
+			 * @param commands	  -	The commands to send to the RCON server.
+			 * @param depth		  -	The maximum number of commands that may be awaiting a response at any given time.
+			 * @param onResponse  -	Callback that is invoked with the index of each command, its response, and details about how it was received.
+			 */
+			void command_pipelined(std::vector<std::string> const& commands, size_t depth, pipelined_response_handler const& onResponse) noexcept(false)
+			{
+				run_sync(async_command_pipelined(commands, depth, onResponse));
+			}
+			/**
+			 * @brief				Sends commands to the RCON server as the source provides them, keeping up to depth commands in flight at once.
+			 *\n					Responses are demultiplexed by packet ID and passed to the callback in submission order.
+			 * @param next		  -	Provides the commands to send to the RCON server, in order.
+			 * @param depth		  -	The maximum number of commands that may be awaiting a response at any given time.
+			 * @param onResponse  -	Callback that is invoked with the index of each command, its response, and details about how it was received.
+			 */
+			void command_pipelined(command_source const& next, size_t depth, pipelined_response_handler const& onResponse) noexcept(false)
+			{
+				run_sync(async_command_pipelined(next, depth, onResponse));
 			}
 
 			/**
@@ -279,55 +1015,185 @@ namespace net {
 			 * @param password	  -	The password to send to the server.
 			 * @returns				True when successful; otherwise, false.
 			 */
-			bool authenticate(std::string_view password)
+			awaitable<bool> async_authenticate(std::string password)
 			{
-				boost::system::error_code ec{};
+				deadline_scope scope{ deadline, authTimeout, "authenticating" };
+				const auto start{ std::chrono::steady_clock::now() };
 
-				const buffer p{ build_packet(packet_header{ get_packet_size(password.size()), 1, (int32_t)PacketType::SERVERDATA_AUTH }, password.data()) };
+				const packet_header header{ make_header(1, PacketType::SERVERDATA_AUTH, password.size()) };
+				const std::array<boost::asio::const_buffer, 3> buffers{
+					boost::asio::buffer(&header, sizeof(packet_header)),
+					boost::asio::buffer(password),
+					boost::asio::buffer(PACKET_TERMINATOR),
+				};
 
-				if (boost::asio::write(socket, boost::asio::buffer(p), ec) != p.size() || ec) {
-					std::clog << MessageHeader(LogLevel::Error) << "Failed to send authentication packet due to error: " << ec.what() << std::endl;
-					return false;
+				if (const auto [sent_bytes, ec] { co_await async_send_buffers(buffers) };
+					sent_bytes != boost::asio::buffer_size(buffers) || ec) {
+					ARRCON_LOG(LogLevel::Error) << "Failed to send authentication packet due to error: " << ec.what() << std::endl;
+					co_return false;
 				}
+				++stats.packetsSent;
 
-				// receive response & return success/fail
-				return recv().first.id != -1;
+				// receive response & return success/fail; Source servers send an empty SERVERDATA_RESPONSE_VALUE packet before the SERVERDATA_AUTH_RESPONSE packet
+				auto response{ co_await async_recv() };
+				while (response.header.type == static_cast<int32_t>(PacketType::SERVERDATA_RESPONSE_VALUE)) {
+					response = co_await async_recv();
+				}
+				stats.record(Phase::Authenticate, std::chrono::steady_clock::now() - start);
+				co_return response.header.id != -1;
+			}
+			/**
+			 * @brief				Authenticates with the connected RCON server by sending the specified password.
+			 * @param password	  -	The password to send to the server.
+			 * @returns				True when successful; otherwise, false.
+			 */
+			bool authenticate(std::string_view password)
+			{
+				return run_sync(async_authenticate(std::string{ password }));
 			}
 
 			/// @brief	Empties the buffer and returns its contents.
 			buffer flush()
 			{
-				const auto bytes{ socket.available() };
-				if (bytes == 0) return {};
+				// take the bytes that were already received but not parsed
+				buffer p{ reader.take() };
 
-				buffer p{ bytes, 0, std::allocator<uint8_t>() };
-				boost::asio::read(socket, boost::asio::buffer(p));
+				if (const auto bytes{ socket.available() }; bytes > 0) {
+					const auto received{ p.size() };
+					p.resize(received + bytes);
+					boost::asio::read(socket, boost::asio::buffer(p.data() + received, bytes));
+				}
+				if (p.empty()) return {};
 
-				std::clog << MessageHeader(LogLevel::Trace) << "Flushed " << bytes << " bytes from the buffer." << std::endl;
+				ARRCON_LOG(LogLevel::Trace) << "Flushed " << p.size() << " bytes from the buffer." << std::endl;
 
 				return p;
 			}
 
 			/**
-			 * @brief				Sets the socket timeout duration in milliseconds.
-			 * @param timeout_ms  -	Number of milliseconds to wait for a response before timing out.
+			 * @brief				Sets the connect, authentication, and command timeouts to the same value.
+			 *\n					Pending operations are cancelled when the timeout expires.
+			 * @param timeout_ms  -	Number of milliseconds that each operation may take before timing out.
 			 */
 			void set_timeout(int timeout_ms)
 			{
-				try {
-					socket.set_option(boost::asio::detail::socket_option::integer<SOL_SOCKET, SO_RCVTIMEO>{ timeout_ms });
-				} catch (std::exception const& ex) {
-					std::clog << MessageHeader(LogLevel::Error) << "Failed to set socket timeout due to exception: \"" << ex.what() << '\"' << std::endl;
-				}
+				connectTimeout = authTimeout = commandTimeout = std::chrono::milliseconds{ timeout_ms };
+			}
+			/**
+			 * @brief			Sets the DNS cache to use when connecting.
+			 * @param cache	  -	A DNS cache that outlives the client, or nullptr to always resolve targets.
+			 */
+			void set_dns_cache(DnsCache* cache) noexcept
+			{
+				dnsCache = cache;
+			}
+			/**
+			 * @brief				Sets the resolver that may already be resolving the target in the background.
+			 *\n					When it is resolving the same target that the client connects to, its endpoints are used instead of resolving again.
+			 * @param resolver	  -	A background resolver that outlives the client, or nullptr.
+			 */
+			void set_background_resolver(BackgroundResolver* resolver) noexcept
+			{
+				backgroundResolver = resolver;
+			}
+			/**
+			 * @brief			Sets the rate limiter that schedules when commands are sent.
+			 * @param limiter -	A rate limiter that outlives the client, or nullptr to send commands as soon as possible.
+			 */
+			void set_rate_limiter(rate_limiter* limiter) noexcept
+			{
+				rateLimiter = limiter;
+			}
+			/**
+			 * @brief				Sets the amount of time that DNS resolution and establishing the connection may take in total.
+			 * @param timeout_ms  -	Number of milliseconds to wait before timing out.
+			 */
+			void set_connect_timeout(int timeout_ms)
+			{
+				connectTimeout = std::chrono::milliseconds{ timeout_ms };
+			}
+			/**
+			 * @brief				Sets how the end of each response is detected.
+			 * @param strategy	  -	The response end strategy to use.
+			 */
+			void set_response_end(response_end_strategy const& strategy) noexcept
+			{
+				responseEnd = strategy;
+			}
+			/**
+			 * @brief				Sets the dialect of the server, which determines how commands that are too large for a single packet are split.
+			 * @param dialect	  -	The dialect to use.
+			 */
+			void set_dialect(Dialect const dialect) noexcept
+			{
+				this->dialect = dialect;
+			}
+			/**
+			 * @brief				Sets the words that are repeated before each part of a Minecraft command that is too large for a single packet.
+			 *\n					Oversized Minecraft commands must start with the split prefix, and can't be split when it is empty.
+			 * @param prefix	  -	The split prefix, e.g. "say".
+			 */
+			void set_split_prefix(std::string prefix)
+			{
+				splitPrefix = std::move(prefix);
+			}
+			/**
+			 * @brief				Sets the amount of time to wait for a connection attempt before starting an attempt with the next endpoint.
+			 * @param delay_ms	  -	Number of milliseconds to wait before starting the next attempt.
+			 */
+			void set_connect_attempt_delay(int delay_ms)
+			{
+				connectAttemptDelay = std::chrono::milliseconds{ delay_ms };
+			}
+			/**
+			 * @brief				Sets the amount of time that authentication may take in total.
+			 * @param timeout_ms  -	Number of milliseconds to wait before timing out.
+			 */
+			void set_auth_timeout(int timeout_ms)
+			{
+				authTimeout = std::chrono::milliseconds{ timeout_ms };
+			}
+			/**
+			 * @brief				Sets the amount of time that sending each command and receiving its complete response may take in total.
+			 * @param timeout_ms  -	Number of milliseconds to wait before timing out.
+			 */
+			void set_command_timeout(int timeout_ms)
+			{
+				commandTimeout = std::chrono::milliseconds{ timeout_ms };
+			}
+
+			/**
+			 * @brief	Checks whether the client is still connected, without blocking.
+			 * @returns	True when the socket is open and the server hasn't closed the connection; otherwise, false.
+			 */
+			bool is_connected()
+			{
+				if (!socket.is_open())
+					return false;
+				if (reader.size() > 0)
+					return true;
+
+				// peek at the socket without blocking; the server closed the connection if this reaches EOF
+				boost::system::error_code ec;
+				const bool wasNonBlocking{ socket.non_blocking() };
+				socket.non_blocking(true, ec);
+
+				char c;
+				socket.receive(boost::asio::buffer(&c, 1), tcp::socket::message_peek, ec);
+
+				boost::system::error_code restore_ec;
+				socket.non_blocking(wasNonBlocking, restore_ec);
+
+				return !ec || ec == boost::asio::error::would_block;
 			}
 
 			/**
-			 * @brief		Gets the current size of the socket's data buffer.
+			 * @brief		Gets the current size of the socket's data buffer, including bytes that were received but not parsed yet.
 			 * @returns		The number of bytes that haven't been read from the buffer yet.
 			 */
 			size_t buffer_size()
 			{
-				return socket.available();
+				return reader.size() + socket.available();
 			}
 		};
 	}
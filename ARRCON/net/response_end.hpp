@@ -0,0 +1,96 @@
+#pragma once
+#include "packet.hpp"
+
+// 307lib::shared
+#include <strcore.hpp>	//< for str::equalsAny
+
+// STL
+#include <chrono>		//< for std::chrono::milliseconds
+#include <cstdint>		//< for sized integer types
+#include <optional>		//< for std::optional
+#include <ostream>		//< for std::ostream
+#include <string>		//< for std::string, std::stoi
+#include <string_view>	//< for std::string_view
+
+namespace net::rcon {
+	/// @brief	Methods of determining when the complete response to a command has been received.
+	enum class ResponseEnd : uint8_t {
+		/// @brief	Sends a blank terminator packet after each command, and waits for the server to echo it back. Works with every server, but costs an extra round trip.
+		Terminator,
+		/// @brief	The response is complete when a response packet is smaller than a full fragment. After a full fragment, waits up to the idle gap for more.
+		Size,
+		/// @brief	The response is complete when no more response packets are received within the idle gap.
+		Idle,
+		/// @brief	The response is complete when the first response packet is received.
+		Single,
+	};
+
+	/// @brief	The body size of a response packet that was filled completely by a Source server, which means that more packets may follow it.
+	inline constexpr const size_t RESPONSE_FRAGMENT_BODY_SIZE{ PACKETSZ_MAX_SEND - (sizeof(packet_header) - sizeof(int32_t)) - PACKET_TERMINATOR.size() };
+
+	/**
+	 * @struct	response_end_strategy
+	 * @brief	Determines how the end of a response is detected. The string form is "<mode>[:<idle gap ms>]", e.g. "size" or "idle:150".
+	 */
+	struct response_end_strategy {
+		/// @brief	The default amount of time to wait for more response packets when using the Size or Idle modes.
+		static constexpr std::chrono::milliseconds DEFAULT_IDLE_GAP{ 100 };
+
+		ResponseEnd mode{ ResponseEnd::Terminator };
+		std::chrono::milliseconds idleGap{ DEFAULT_IDLE_GAP };
+
+		/**
+		 * @brief			Parses a response end strategy from its string form.
+		 * @param text	  -	The string to parse. The mode is case-insensitive.
+		 * @returns			The response end strategy when successful; otherwise, std::nullopt.
+		 */
+		static std::optional<response_end_strategy> parse(std::string_view text)
+		{
+			response_end_strategy strategy;
+
+			const auto sep{ text.find(':') };
+			if (sep != std::string_view::npos) {
+				const auto gap{ text.substr(sep + 1) };
+				if (gap.empty() || gap.size() > 9 || gap.find_first_not_of("0123456789") != std::string_view::npos)
+					return std::nullopt;
+				strategy.idleGap = std::chrono::milliseconds{ std::stoi(std::string{ gap }) };
+			}
+
+			const std::string mode{ text.substr(0, sep) };
+			if (str::equalsAny<false>(mode, "terminator"))
+				strategy.mode = ResponseEnd::Terminator;
+			else if (str::equalsAny<false>(mode, "size"))
+				strategy.mode = ResponseEnd::Size;
+			else if (str::equalsAny<false>(mode, "idle"))
+				strategy.mode = ResponseEnd::Idle;
+			else if (str::equalsAny<false>(mode, "single"))
+				strategy.mode = ResponseEnd::Single;
+			else return std::nullopt;
+
+			return strategy;
+		}
+
+		friend bool operator==(response_end_strategy const&, response_end_strategy const&) = default;
+
+		friend std::ostream& operator<<(std::ostream& os, const response_end_strategy& s)
+		{
+			switch (s.mode) {
+			case ResponseEnd::Terminator:
+				os << "terminator";
+				break;
+			case ResponseEnd::Size:
+				os << "size";
+				break;
+			case ResponseEnd::Idle:
+				os << "idle";
+				break;
+			case ResponseEnd::Single:
+				os << "single";
+				break;
+			}
+			if (s.idleGap != DEFAULT_IDLE_GAP)
+				os << ':' << s.idleGap.count();
+			return os;
+		}
+	};
+}
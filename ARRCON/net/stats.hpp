@@ -0,0 +1,208 @@
+#pragma once
+// STL
+#include <algorithm>	//< for std::max, std::min
+#include <array>		//< for std::array
+#include <bit>			//< for std::bit_width
+#include <chrono>		//< for std::chrono
+#include <cstdint>		//< for sized integer types
+#include <iomanip>		//< for std::setw, std::setprecision
+#include <ostream>		//< for std::ostream
+#include <string_view>	//< for std::string_view
+
+namespace net::rcon {
+	/// @brief	The phases of communicating with an RCON server that are timed by client_stats.
+	enum class Phase : uint8_t {
+		/// @brief	Resolving the target hostname. Not recorded when the endpoints were cached.
+		Resolve,
+		/// @brief	Establishing the TCP connection.
+		Connect,
+		/// @brief	Sending the password & receiving the authentication response.
+		Authenticate,
+		/// @brief	Writing a command to the socket.
+		Send,
+		/// @brief	From sending a command until its first response packet is received.
+		FirstByte,
+		/// @brief	From sending a command until its complete response is received.
+		LastByte,
+	};
+	inline constexpr const size_t PHASE_COUNT{ static_cast<size_t>(Phase::LastByte) + 1 };
+	inline constexpr const std::array<std::string_view, PHASE_COUNT> PHASE_NAMES{ "resolve", "connect", "authenticate", "send", "first_byte", "last_byte" };
+
+	/// @brief	Details about how the response to a single command was received.
+	struct response_info {
+		/// @brief	The number of response packets that were received.
+		size_t packets{ 0 };
+		/// @brief	The amount of time from sending the command until its first response packet was received.
+		std::chrono::steady_clock::duration firstByte{};
+		/// @brief	The amount of time from sending the command until its complete response was received.
+		std::chrono::steady_clock::duration lastByte{};
+	};
+
+	/**
+	 * @class	latency_histogram
+	 * @brief	Fixed-size log-linear histogram of durations with microsecond resolution.
+	 *\n		Each power of two is split into 16 buckets, so percentiles are accurate to within ~6%.
+	 */
+	class latency_histogram {
+		static constexpr unsigned SUB_BUCKET_BITS{ 4 };
+		static constexpr unsigned SUB_BUCKETS{ 1u << SUB_BUCKET_BITS };
+		/// @brief	Enough buckets for durations up to 2^40µs (~12 days).
+		static constexpr size_t BUCKET_COUNT{ (40 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS };
+
+		std::array<uint64_t, BUCKET_COUNT> buckets{};
+		uint64_t total{ 0 };
+		uint64_t sum_us{ 0 };
+		uint64_t max_us{ 0 };
+
+		static constexpr size_t bucket_of(uint64_t const us) noexcept
+		{
+			if (us < SUB_BUCKETS) return static_cast<size_t>(us);
+			const unsigned msb{ static_cast<unsigned>(std::bit_width(us)) - 1 };
+			const size_t sub{ static_cast<size_t>(us >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1) };
+			return std::min(static_cast<size_t>(msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub, BUCKET_COUNT - 1);
+		}
+		/// @brief	Gets the largest value that is counted in the specified bucket.
+		static constexpr uint64_t upper_bound_of(size_t const bucket) noexcept
+		{
+			if (bucket < SUB_BUCKETS) return bucket;
+			const unsigned msb{ static_cast<unsigned>(bucket / SUB_BUCKETS) + SUB_BUCKET_BITS - 1 };
+			const uint64_t sub{ bucket % SUB_BUCKETS };
+			return ((SUB_BUCKETS + sub + 1) << (msb - SUB_BUCKET_BITS)) - 1;
+		}
+
+	public:
+		/// @brief	Adds a duration to the histogram.
+		void record(std::chrono::steady_clock::duration const duration) noexcept
+		{
+			const auto us{ static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0)) };
+			++buckets[bucket_of(us)];
+			++total;
+			sum_us += us;
+			max_us = std::max(max_us, us);
+		}
+		/// @brief	Adds the durations recorded by another histogram to this one.
+		void merge(latency_histogram const& other) noexcept
+		{
+			for (size_t i{ 0 }; i < BUCKET_COUNT; ++i) {
+				buckets[i] += other.buckets[i];
+			}
+			total += other.total;
+			sum_us += other.sum_us;
+			max_us = std::max(max_us, other.max_us);
+		}
+
+		/// @brief	Gets the number of recorded durations.
+		uint64_t count() const noexcept { return total; }
+		/// @brief	Gets the longest recorded duration, in microseconds.
+		uint64_t max() const noexcept { return max_us; }
+		/// @brief	Gets the mean of the recorded durations, in microseconds.
+		uint64_t mean() const noexcept { return total == 0 ? 0 : sum_us / total; }
+		/**
+		 * @brief				Gets the specified percentile of the recorded durations.
+		 * @param percentile  -	The percentile to get, from 0 to 100.
+		 * @returns				The upper bound of the bucket containing the percentile, in microseconds.
+		 */
+		uint64_t percentile(double const percentile) const noexcept
+		{
+			if (total == 0) return 0;
+			const auto rank{ std::max<uint64_t>(static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5), 1) };
+			uint64_t seen{ 0 };
+			for (size_t i{ 0 }; i < BUCKET_COUNT; ++i) {
+				if ((seen += buckets[i]) >= rank)
+					return std::min(upper_bound_of(i), max_us);
+			}
+			return max_us;
+		}
+	};
+
+	/**
+	 * @struct	client_stats
+	 * @brief	Latency histograms for each phase, and traffic counters, that are recorded by an RconClient.
+	 */
+	struct client_stats {
+		std::array<latency_histogram, PHASE_COUNT> phases{};
+		uint64_t commands{ 0 };
+		uint64_t packetsSent{ 0 };
+		uint64_t packetsReceived{ 0 };
+		uint64_t bytesSent{ 0 };
+		uint64_t bytesReceived{ 0 };
+
+		/// @brief	Records the duration of a phase.
+		void record(Phase const phase, std::chrono::steady_clock::duration const duration) noexcept
+		{
+			phases[static_cast<size_t>(phase)].record(duration);
+		}
+		/// @brief	Gets the histogram of the specified phase.
+		latency_histogram const& operator[](Phase const phase) const noexcept
+		{
+			return phases[static_cast<size_t>(phase)];
+		}
+
+		/// @brief	Adds the statistics recorded by another client to this one.
+		void merge(client_stats const& other) noexcept
+		{
+			for (size_t i{ 0 }; i < PHASE_COUNT; ++i) {
+				phases[i].merge(other.phases[i]);
+			}
+			commands += other.commands;
+			packetsSent += other.packetsSent;
+			packetsReceived += other.packetsReceived;
+			bytesSent += other.bytesSent;
+			bytesReceived += other.bytesReceived;
+		}
+
+		/// @brief	Prints the statistics as a human-readable table, with durations in milliseconds.
+		void print(std::ostream& os) const
+		{
+			const auto ms{ [](uint64_t const us) { return static_cast<double>(us) / 1000.0; } };
+
+			os << std::left << std::setw(14) << "phase" << std::right
+				<< std::setw(8) << "count"
+				<< std::setw(11) << "p50 (ms)"
+				<< std::setw(11) << "p90 (ms)"
+				<< std::setw(11) << "p99 (ms)"
+				<< std::setw(11) << "max (ms)" << '\n'
+				<< std::fixed << std::setprecision(3);
+			for (size_t i{ 0 }; i < PHASE_COUNT; ++i) {
+				const auto& h{ phases[i] };
+				if (h.count() == 0) continue;
+				os << std::left << std::setw(14) << PHASE_NAMES[i] << std::right
+					<< std::setw(8) << h.count()
+					<< std::setw(11) << ms(h.percentile(50))
+					<< std::setw(11) << ms(h.percentile(90))
+					<< std::setw(11) << ms(h.percentile(99))
+					<< std::setw(11) << ms(h.max()) << '\n';
+			}
+			os << std::defaultfloat
+				<< "commands: " << commands
+				<< ", packets sent/received: " << packetsSent << '/' << packetsReceived
+				<< ", bytes sent/received: " << bytesSent << '/' << bytesReceived << '\n';
+		}
+		/// @brief	Prints the statistics as a single JSON object, with durations in microseconds.
+		void print_json(std::ostream& os) const
+		{
+			os << "{\"phases\":{";
+			bool first{ true };
+			for (size_t i{ 0 }; i < PHASE_COUNT; ++i) {
+				const auto& h{ phases[i] };
+				if (h.count() == 0) continue;
+				if (first) first = false;
+				else os << ',';
+				os << '"' << PHASE_NAMES[i] << "\":{"
+					<< "\"count\":" << h.count()
+					<< ",\"mean_us\":" << h.mean()
+					<< ",\"p50_us\":" << h.percentile(50)
+					<< ",\"p90_us\":" << h.percentile(90)
+					<< ",\"p99_us\":" << h.percentile(99)
+					<< ",\"max_us\":" << h.max()
+					<< '}';
+			}
+			os << "},\"commands\":" << commands
+				<< ",\"packets_sent\":" << packetsSent
+				<< ",\"packets_received\":" << packetsReceived
+				<< ",\"bytes_sent\":" << bytesSent
+				<< ",\"bytes_received\":" << bytesReceived
+				<< "}\n";
+		}
+	};
+}
@@ -1,4 +1,8 @@
 #pragma once
+#include "command_dialect.hpp"
+#include "response_end.hpp"
+
+// STL
 #include <string>	//< for std::string
 
 namespace net::rcon {
@@ -6,10 +10,14 @@ namespace net::rcon {
 		std::string host;
 		std::string port;
 		std::string pass;
+		/// @brief	How the end of each response from the target is detected.
+		response_end_strategy responseEnd{};
+		/// @brief	How commands that are too large for a single packet are split.
+		Dialect dialect{ Dialect::None };
 
 		friend bool operator==(target_info const& a, target_info const& b)
 		{
-			return a.host == b.host && a.port == b.port && a.pass == b.pass;
+			return a.host == b.host && a.port == b.port && a.pass == b.pass && a.responseEnd == b.responseEnd && a.dialect == b.dialect;
 		}
 
 		friend std::ostream& operator<<(std::ostream& os, const target_info& t)
@@ -0,0 +1,311 @@
+// ARRCON
+#include <net/multiplexed_client.hpp>
+#include "mock_server.hpp"
+
+// 307lib
+#include <opt3.hpp>		//< for commandline argument parser & manager
+#include <strcore.hpp>	//< for str::tonumber
+
+// STL
+#include <atomic>		//< for std::atomic
+#include <chrono>		//< for std::chrono
+#include <future>		//< for std::future
+#include <iomanip>		//< for std::setw, std::setprecision
+#include <iostream>		//< for standard io streams
+#include <string>		//< for std::string
+#include <thread>		//< for std::thread
+#include <vector>		//< for std::vector
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>		//< for GetProcessMemoryInfo
+#else
+#include <sys/resource.h>	//< for getrusage
+#endif
+
+struct print_help {
+	std::string exeName;
+
+	print_help(const std::string& exeName) : exeName{ exeName } {}
+
+	friend std::ostream& operator<<(std::ostream& os, const print_help& h)
+	{
+		return os << "Benchmarks ARRCON's RCON client against an in-process mock Source RCON server.\n"
+			<< '\n'
+			<< "USAGE:\n"
+			<< "  " << h.exeName << " [OPTIONS]\n"
+			<< '\n'
+			<< "OPTIONS:\n"
+			<< "  -h, --help                  Shows this help display, then exits." << '\n'
+			<< "  -n, --count <N>             Sets the number of commands to send in each scenario. Default: 10000" << '\n'
+			<< "  -s, --scenario <Name,...>   Only runs the specified scenarios. Default: all" << '\n'
+			<< "                              Scenarios: small, large, pipelined, latency, single, minecraft, multiplexed" << '\n'
+			<< "      --serve <port>          Runs the mock server in the foreground on the specified port instead, for use with" << '\n'
+			<< "                               other clients. The following options configure it:" << '\n'
+			<< "      --password <pass>       The password that clients must use. Default: bench" << '\n'
+			<< "      --size <bytes>          The size of the response to each command. Default: 64" << '\n'
+			<< "      --fragment <bytes>      The largest response body sent in a single packet. Default: 4096" << '\n'
+			<< "      --latency <us>          The number of microseconds to wait before responding to each command. Default: 0" << '\n'
+			<< "      --minecraft             Emulates the quirks of Minecraft's RCON server." << '\n'
+			<< "      --echo                  Responds to each command with the command itself. \"wait <ms> <text>\" is answered" << '\n'
+			<< "                               with <text> after <ms> milliseconds, without delaying other commands." << '\n'
+			;
+	}
+};
+
+struct scenario {
+	std::string_view name;
+	bench::mock_server_settings server;
+	size_t pipelineDepth{ 1 };
+	net::rcon::response_end_strategy responseEnd{};
+	/// @brief	The number of commands to send is divided by this, for slow scenarios.
+	size_t countDivisor{ 1 };
+};
+
+/// @brief	Gets the peak resident set size of the process, in KiB.
+inline size_t get_peak_rss_kib()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc{};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return 0;
+	return pmc.PeakWorkingSetSize / 1024;
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss) / 1024; //< bytes on macOS
+#else
+	return static_cast<size_t>(usage.ru_maxrss); //< KiB on Linux
+#endif
+#endif
+}
+
+/**
+ * @brief				Prints a row of the results table.
+ * @param name		  -	The name of the scenario.
+ * @param count		  -	The number of commands that were sent.
+ * @param elapsed	  -	How long it took to send the commands & receive their responses.
+ * @param lastByte	  -	The latency of each command's last byte.
+ */
+void print_results(std::string_view const name, size_t const count, std::chrono::duration<double> const elapsed, net::rcon::latency_histogram const& lastByte)
+{
+	const auto ms{ [](uint64_t const us) { return static_cast<double>(us) / 1000.0; } };
+
+	std::cout
+		<< std::left << std::setw(12) << name << std::right
+		<< std::setw(10) << count
+		<< std::setw(12) << std::fixed << std::setprecision(0) << static_cast<double>(count) / elapsed.count()
+		<< std::setprecision(3)
+		<< std::setw(11) << ms(lastByte.percentile(50))
+		<< std::setw(11) << ms(lastByte.percentile(90))
+		<< std::setw(11) << ms(lastByte.percentile(99))
+		<< std::setw(11) << ms(lastByte.max())
+		<< std::setw(12) << get_peak_rss_kib()
+		<< std::defaultfloat;
+}
+
+/**
+ * @brief				Runs a single benchmark scenario and prints the results.
+ * @param s			  -	The scenario to run.
+ * @param count		  -	The number of commands to send.
+ */
+void run_scenario(scenario const& s, size_t const count)
+{
+	bench::MockServer server{ s.server };
+
+	net::rcon::RconClient client;
+	client.set_response_end(s.responseEnd);
+	client.connect("127.0.0.1", std::to_string(server.port()));
+	if (!client.authenticate(s.server.password))
+		throw make_exception("Authentication with the mock server failed!");
+
+	const std::string command{ "bench" };
+	size_t receivedBytes{ 0 };
+
+	const auto start{ std::chrono::steady_clock::now() };
+	if (s.pipelineDepth > 1) {
+		const std::vector<std::string> commands(count, command);
+		client.command_pipelined(commands, s.pipelineDepth, [&receivedBytes](size_t, std::string&& response, net::rcon::response_info const&) { receivedBytes += response.size(); });
+	}
+	else {
+		for (size_t i{ 0 }; i < count; ++i) {
+			client.command(command, [&receivedBytes](std::string_view chunk) { receivedBytes += chunk.size(); });
+		}
+	}
+	const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+	print_results(s.name, count, elapsed, client.get_stats()[net::rcon::Phase::LastByte]);
+	if (receivedBytes != count * s.server.responseSize)
+		std::cout << "  (received " << receivedBytes << '/' << count * s.server.responseSize << " bytes!)";
+	std::cout << std::endl;
+}
+
+/**
+ * @brief				Sends commands from several threads at once through a MultiplexedClient, and prints the results.
+ *\n					Every command is unique & echoed back by the server, so each response can be checked against its command.
+ *					 Some responses are delayed so that they arrive after the responses to later commands, and the first command
+ *					 of each thread is delayed for longer than the command timeout, which must fail without affecting the others.
+ * @param count		  -	The number of commands to send.
+ */
+void run_multiplexed_scenario(size_t const count)
+{
+	constexpr size_t THREADS{ 4 }, WINDOW{ 16 };
+	constexpr std::chrono::milliseconds COMMAND_TIMEOUT{ 100 };
+
+	bench::MockServer server{ { .echo = true } };
+
+	net::rcon::MultiplexedClient client;
+	client.get_client().set_command_timeout(static_cast<int>(COMMAND_TIMEOUT.count()));
+	client.connect("127.0.0.1", std::to_string(server.port()), "bench");
+
+	std::atomic<size_t> mismatched{ 0 }, timedOut{ 0 }, expectedTimeouts{ 0 };
+
+	const auto start{ std::chrono::steady_clock::now() };
+	std::vector<std::thread> threads;
+	for (size_t t{ 0 }; t < THREADS; ++t) {
+		threads.emplace_back([&, t] {
+			const size_t n{ count / THREADS + (t < count % THREADS) };
+			// each thread keeps up to WINDOW commands in flight
+			for (size_t begin{ 0 }; begin < n; begin += WINDOW) {
+				std::vector<std::pair<std::string, std::future<std::string>>> window;
+				for (size_t i{ begin }; i < std::min(n, begin + WINDOW); ++i) {
+					auto text{ std::to_string(t) + '-' + std::to_string(i) };
+					std::string command{ text };
+					if (i == 0) {
+						command = "wait " + std::to_string(COMMAND_TIMEOUT.count() * 3) + ' ' + text;
+						++expectedTimeouts;
+					}
+					else if (i % 4 == 0)
+						command = "wait 1 " + text;
+					auto future{ client.command(std::move(command)) };
+					window.emplace_back(std::move(text), std::move(future));
+				}
+				for (auto& [text, future] : window) {
+					try {
+						if (future.get() != text)
+							++mismatched;
+					} catch (std::exception const&) {
+						++timedOut;
+					}
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+	// the futures have all completed, so the I/O thread is no longer recording statistics
+	print_results("multiplexed", count, elapsed, client.get_client().get_stats()[net::rcon::Phase::LastByte]);
+	if (mismatched != 0)
+		std::cout << "  (" << mismatched << " responses didn't match their command!)";
+	if (timedOut != expectedTimeouts)
+		std::cout << "  (" << timedOut << '/' << expectedTimeouts << " commands timed out!)";
+	std::cout << std::endl;
+}
+
+int main_impl(const int argc, char** argv)
+{
+	const opt3::ArgManager args{ argc, argv,
+		// define capturing args:
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 'n', "count"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, 's', "scenario"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "serve"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "password"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "size"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "fragment"),
+		opt3::make_template(opt3::CaptureStyle::Required, opt3::ConflictStyle::Conflict, "latency"),
+	};
+
+	if (args.check_any<opt3::Flag, opt3::Option>('h', "help")) {
+		std::cout << print_help("ARRCON_bench");
+		return 0;
+	}
+
+	// the client's log output isn't wanted here
+	std::clog.rdbuf(nullptr);
+
+	// --serve
+	if (const auto& arg_serve{ args.getv_any<opt3::Option>("serve") }; arg_serve.has_value()) {
+		bench::mock_server_settings settings;
+		settings.password = args.getv_any<opt3::Option>("password").value_or(settings.password);
+		settings.responseSize = args.castgetv_any<size_t, opt3::Option>([](auto&& arg) { return str::tonumber<size_t>(std::forward<decltype(arg)>(arg)); }, "size").value_or(settings.responseSize);
+		settings.fragmentSize = args.castgetv_any<size_t, opt3::Option>([](auto&& arg) { return str::tonumber<size_t>(std::forward<decltype(arg)>(arg)); }, "fragment").value_or(settings.fragmentSize);
+		settings.latency = std::chrono::microseconds{ args.castgetv_any<int64_t, opt3::Option>([](auto&& arg) { return str::tonumber<int64_t>(std::forward<decltype(arg)>(arg)); }, "latency").value_or(0) };
+		settings.minecraft = args.check<opt3::Option>("minecraft");
+		settings.echo = args.check<opt3::Option>("echo");
+
+		bench::MockServer server{ settings, static_cast<unsigned short>(str::tonumber<unsigned>(arg_serve.value())) };
+		std::cout << "Mock server listening on 127.0.0.1:" << server.port() << " with password \"" << settings.password << "\"." << std::endl;
+		server.wait();
+		return 0;
+	}
+
+	// -n|--count
+	const size_t count{ args.castgetv_any<size_t, opt3::Flag, opt3::Option>([](auto&& arg) { return str::tonumber<size_t>(std::forward<decltype(arg)>(arg)); }, 'n', "count").value_or(10000) };
+
+	const std::vector<scenario> scenarios{
+		// one packet per response
+		{ "small", { .responseSize = 64 } },
+		// 16 fragments per response
+		{ "large", { .responseSize = 64 * 1024 }, 1, {}, 10 },
+		// up to 16 commands in flight
+		{ "pipelined", { .responseSize = 64 }, 16 },
+		// 1ms of server-side latency per command
+		{ "latency", { .responseSize = 64, .latency = std::chrono::milliseconds{ 1 } }, 1, {}, 10 },
+		// no terminator packet round trip
+		{ "single", { .responseSize = 64 }, 1, { net::rcon::ResponseEnd::Single } },
+		// Minecraft quirks
+		{ "minecraft", { .responseSize = 64, .fragmentSize = 4096, .minecraft = true } },
+	};
+
+	// -s|--scenario
+	const auto arg_scenario{ args.getv_any<opt3::Flag, opt3::Option>('s', "scenario") };
+	const auto isSelected{ [&arg_scenario](std::string_view name) {
+		if (!arg_scenario.has_value()) return true;
+		const std::string_view names{ arg_scenario.value() };
+		for (size_t pos{ 0 }, end{ 0 }; pos <= names.size(); pos = end + 1) {
+			if (end = names.find(',', pos); end == std::string_view::npos)
+				end = names.size();
+			if (names.substr(pos, end - pos) == name)
+				return true;
+		}
+		return false;
+	} };
+
+	std::cout
+		<< std::left << std::setw(12) << "scenario" << std::right
+		<< std::setw(10) << "commands"
+		<< std::setw(12) << "cmds/sec"
+		<< std::setw(11) << "p50 (ms)"
+		<< std::setw(11) << "p90 (ms)"
+		<< std::setw(11) << "p99 (ms)"
+		<< std::setw(11) << "max (ms)"
+		<< std::setw(12) << "RSS (KiB)" << std::endl;
+
+	for (const auto& s : scenarios) {
+		if (isSelected(s.name))
+			run_scenario(s, std::max<size_t>(count / s.countDivisor, 1));
+	}
+	// several threads sharing one connection
+	if (isSelected("multiplexed"))
+		run_multiplexed_scenario(count);
+
+	return 0;
+}
+
+int main(const int argc, char** argv)
+{
+	try {
+		return main_impl(argc, argv);
+	} catch (std::exception const& ex) {
+		std::cerr << "[FATAL] " << ex.what() << std::endl;
+		return 1;
+	} catch (...) {
+		std::cerr << "[FATAL] An undefined error occurred!" << std::endl;
+		return 1;
+	}
+}
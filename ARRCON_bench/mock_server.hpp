@@ -0,0 +1,241 @@
+#pragma once
+#include <net/packet.hpp>
+
+// Boost::asio
+#include <boost/asio.hpp>
+#include <boost/asio/awaitable.hpp>			//< for boost::asio::awaitable
+#include <boost/asio/co_spawn.hpp>			//< for boost::asio::co_spawn
+#include <boost/asio/detached.hpp>			//< for boost::asio::detached
+#include <boost/asio/steady_timer.hpp>		//< for boost::asio::steady_timer
+#include <boost/asio/use_awaitable.hpp>		//< for boost::asio::use_awaitable
+
+// STL
+#include <array>		//< for std::array
+#include <chrono>		//< for std::chrono
+#include <charconv>		//< for std::from_chars
+#include <cstring>		//< for std::memcpy
+#include <memory>		//< for std::shared_ptr
+#include <string>		//< for std::string
+#include <string_view>	//< for std::string_view
+#include <thread>		//< for std::thread
+#include <utility>		//< for std::exchange
+
+namespace bench {
+	using boost::asio::io_context;
+	using boost::asio::ip::tcp;
+	using boost::asio::awaitable;
+	using boost::asio::use_awaitable;
+	using net::rcon::PacketType;
+	using net::rcon::packet_header;
+
+	struct mock_server_settings {
+		/// @brief	The password that clients must authenticate with.
+		std::string password{ "bench" };
+		/// @brief	The number of bytes in the response to each command.
+		size_t responseSize{ 64 };
+		/// @brief	The largest response body that is sent in a single packet; larger responses are split into multiple packets.
+		size_t fragmentSize{ 4096 };
+		/// @brief	Artificial delay before responding to each command.
+		std::chrono::microseconds latency{ 0 };
+		/// @brief	Behave like a Minecraft server: the authentication response isn't preceded by an empty packet,
+		///			 and packets of unknown types (including terminator packets) are answered with an error message.
+		bool minecraft{ false };
+		/// @brief	Respond to each command with its own body instead of the generated response, so that clients can check which command
+		///			 each response belongs to. Commands of the form "wait <ms> <text>" are answered with <text> after <ms> milliseconds,
+		///			 and the commands that follow them are answered in the meantime.
+		bool echo{ false };
+	};
+
+	/**
+	 * @class	MockServer
+	 * @brief	A Source RCON server that listens on a loopback port and runs on its own thread.
+	 *\n		Every command receives the same response, which is generated from the settings.
+	 */
+	class MockServer {
+		/// @brief	A client connection, which is shared with the responses that are delayed by echo mode.
+		struct connection {
+			tcp::socket socket;
+			/// @brief	Responses that are waiting to be written.
+			std::string queued;
+			bool writing{ false };
+		};
+		/// @brief	A response that is delayed by echo mode, along with the response to the terminator packet that follows its command.
+		struct delayed_response {
+			std::string out;
+			bool sent{ false };
+		};
+
+		mock_server_settings settings;
+		io_context ioContext;
+		tcp::acceptor acceptor;
+		/// @brief	The response body that is sent for every command.
+		std::string response;
+		std::thread thread;
+
+		static void append_packet(std::string& out, int32_t const id, PacketType const type, std::string_view body)
+		{
+			const packet_header header{ net::rcon::get_packet_size(body.size()), id, static_cast<int32_t>(type) };
+			const auto pos{ out.size() };
+			out.resize(pos + sizeof(packet_header));
+			std::memcpy(out.data() + pos, &header, sizeof(packet_header));
+			out.append(body);
+			out.append(net::rcon::PACKET_TERMINATOR.size(), '\0');
+		}
+
+		/// @brief	Writes the queued responses of a connection until there are none left.
+		static awaitable<void> async_flush(std::shared_ptr<connection> conn)
+		{
+			std::string buf;
+			try {
+				while (!conn->queued.empty()) {
+					buf.clear();
+					std::swap(buf, conn->queued);
+					co_await boost::asio::async_write(conn->socket, boost::asio::buffer(buf), use_awaitable);
+				}
+			} catch (std::exception const&) {
+				conn->queued.clear(); //< the client disconnected
+			}
+			conn->writing = false;
+		}
+		/// @brief	Queues a response to be written; responses are written by one coroutine at a time, in the order they were queued.
+		void send(std::shared_ptr<connection> const& conn, std::string_view const out)
+		{
+			conn->queued.append(out);
+			if (!std::exchange(conn->writing, true))
+				boost::asio::co_spawn(ioContext, async_flush(conn), boost::asio::detached);
+		}
+		/// @brief	Sends a delayed response once its delay has elapsed.
+		awaitable<void> async_send_delayed(std::shared_ptr<connection> conn, std::shared_ptr<delayed_response> response, std::chrono::milliseconds const delay)
+		{
+			boost::asio::steady_timer timer{ ioContext, delay };
+			co_await timer.async_wait(use_awaitable);
+			response->sent = true;
+			send(conn, response->out);
+		}
+
+		awaitable<void> session(tcp::socket socket)
+		{
+			boost::system::error_code ec;
+			socket.set_option(tcp::no_delay{ true }, ec);
+			const auto conn{ std::make_shared<connection>(std::move(socket)) };
+
+			boost::asio::steady_timer timer{ ioContext };
+			std::string body, out;
+			// the most recent delayed response, which the response to the following terminator packet is sent with
+			std::shared_ptr<delayed_response> delayed;
+			try {
+				while (true) {
+					packet_header header;
+					co_await boost::asio::async_read(conn->socket, boost::asio::buffer(&header, sizeof(packet_header)), use_awaitable);
+
+					if (header.size + static_cast<int32_t>(sizeof(int32_t)) < net::rcon::PACKETSZ_MIN || header.size > net::rcon::PACKETSZ_MAX_SEND)
+						co_return; //< malformed packet; drop the connection
+
+					body.resize(static_cast<size_t>(header.size) - (sizeof(packet_header) - sizeof(int32_t)));
+					co_await boost::asio::async_read(conn->socket, boost::asio::buffer(body), use_awaitable);
+					body.resize(body.size() - net::rcon::PACKET_TERMINATOR.size());
+
+					out.clear();
+					switch (static_cast<PacketType>(header.type)) {
+					case PacketType::SERVERDATA_AUTH:
+						if (!settings.minecraft)
+							append_packet(out, header.id, PacketType::SERVERDATA_RESPONSE_VALUE, {});
+						append_packet(out, body == settings.password ? header.id : -1, PacketType::SERVERDATA_AUTH_RESPONSE, {});
+						break;
+					case PacketType::SERVERDATA_EXECCOMMAND:
+						if (settings.latency.count() > 0) {
+							timer.expires_after(settings.latency);
+							co_await timer.async_wait(use_awaitable);
+						}
+						if (settings.echo) {
+							std::string_view text{ body };
+							int delay_ms{ 0 };
+							if (text.starts_with("wait ")) {
+								text.remove_prefix(5);
+								const auto [ptr, parse_ec] { std::from_chars(text.data(), text.data() + text.size(), delay_ms) };
+								text.remove_prefix(std::min(text.size(), static_cast<size_t>(ptr - text.data()) + 1));
+							}
+							for (size_t pos{ 0 }; pos < text.size() || pos == 0; pos += settings.fragmentSize) {
+								append_packet(out, header.id, PacketType::SERVERDATA_RESPONSE_VALUE, text.substr(pos, settings.fragmentSize));
+								if (text.empty()) break;
+							}
+							if (delay_ms > 0) {
+								delayed = std::make_shared<delayed_response>(std::move(out));
+								boost::asio::co_spawn(ioContext, async_send_delayed(conn, delayed, std::chrono::milliseconds{ delay_ms }), boost::asio::detached);
+								continue;
+							}
+							break;
+						}
+						for (size_t pos{ 0 }; pos < response.size() || pos == 0; pos += settings.fragmentSize) {
+							append_packet(out, header.id, PacketType::SERVERDATA_RESPONSE_VALUE, std::string_view{ response }.substr(pos, settings.fragmentSize));
+							if (response.empty()) break;
+						}
+						break;
+					default:
+						if (settings.minecraft)
+							append_packet(out, header.id, PacketType::SERVERDATA_RESPONSE_VALUE, "Unknown request " + std::to_string(header.type));
+						else // mirror the packet, like Source servers do with terminator packets
+							append_packet(out, header.id, PacketType::SERVERDATA_RESPONSE_VALUE, body);
+
+						// the terminator of a delayed command is answered after the command
+						if (delayed && !delayed->sent) {
+							delayed->out.append(out);
+							delayed.reset();
+							continue;
+						}
+						break;
+					}
+
+					delayed.reset();
+					send(conn, out);
+				}
+			} catch (std::exception const&) {
+				// the client disconnected
+			}
+		}
+
+		awaitable<void> accept_loop()
+		{
+			while (true) {
+				auto socket{ co_await acceptor.async_accept(use_awaitable) };
+				boost::asio::co_spawn(ioContext, session(std::move(socket)), boost::asio::detached);
+			}
+		}
+
+	public:
+		/**
+		 * @brief				Starts a mock server on the loopback interface.
+		 * @param settings	  -	The settings to use.
+		 * @param port		  -	The port to listen on, or 0 to pick any available port.
+		 */
+		MockServer(mock_server_settings const& settings, unsigned short const port = 0) :
+			settings{ settings },
+			acceptor{ ioContext, tcp::endpoint{ boost::asio::ip::address_v4::loopback(), port } },
+			response(settings.responseSize, '\0')
+		{
+			for (size_t i{ 0 }; i < response.size(); ++i) {
+				response[i] = static_cast<char>('a' + i % 26);
+			}
+			if (this->settings.fragmentSize == 0)
+				this->settings.fragmentSize = 4096;
+
+			boost::asio::co_spawn(ioContext, accept_loop(), boost::asio::detached);
+			thread = std::thread([this] { ioContext.run(); });
+		}
+		~MockServer()
+		{
+			ioContext.stop();
+			if (thread.joinable())
+				thread.join();
+		}
+
+		/// @brief	Gets the port that the server is listening on.
+		unsigned short port() const { return acceptor.local_endpoint().port(); }
+		/// @brief	Blocks until the server is stopped.
+		void wait()
+		{
+			if (thread.joinable())
+				thread.join();
+		}
+	};
+}